@@ -0,0 +1,125 @@
+#include "analysisengine.h"
+#include "profiler.h"
+
+// analysed batches kept for lookup, covers the playout delay of the display
+static const size_t recent_results = 32;
+
+AnalysisEngine::AnalysisEngine(QObject* parent) :
+    QObject(parent), analyse_time_(0.0), sigma_ref_(0.0), regions_(nullptr), mesh_generation_(0),
+    sample_id_(1) {
+    // create separat thread
+    this->thread_ = new QThread(this);
+    this->thread()->setObjectName("analysis engine");
+    this->moveToThread(this->thread());
+
+    this->thread()->start();
+}
+
+void AnalysisEngine::init(const Eigen::ArrayXf& element_area, mpFlow::dtype::real sigma_ref,
+    quint64 mesh_generation, std::shared_ptr<const RegionsOfInterest> regions) {
+    QMutexLocker locker(&this->mutex_);
+
+    // normalized weights turn weighted sums directly into means
+    this->weights_ = element_area / element_area.sum();
+    this->sigma_ref_ = sigma_ref;
+    this->regions_ = regions;
+    this->mesh_generation_ = mesh_generation;
+    this->recent_.clear();
+}
+
+std::shared_ptr<const AnalysisResults> AnalysisEngine::latest() {
+    QMutexLocker locker(&this->mutex_);
+
+    return this->recent_.empty() ? std::make_shared<AnalysisResults>() : this->recent_.front();
+}
+
+bool AnalysisEngine::statistics(const RenderFrames& frames, mpFlow::dtype::index column,
+    FrameStatistics* statistics) {
+    QMutexLocker locker(&this->mutex_);
+
+    // same batch or batch holding frame with same acquisition time stamp
+    for (const auto& results : this->recent_) {
+        if (results->frames.get() == &frames) {
+            if (column >= results->statistics.size()) {
+                return false;
+            }
+            *statistics = results->statistics[column];
+            return true;
+        }
+        if ((column >= frames.timestamps.size()) ||
+            (results->frames->mesh_generation != frames.mesh_generation)) {
+            continue;
+        }
+        const auto& timestamps = results->frames->timestamps;
+        for (mpFlow::dtype::index i = 0; i < std::min((size_t)timestamps.size(),
+            results->statistics.size()); ++i) {
+            if (timestamps(i) == frames.timestamps(column)) {
+                *statistics = results->statistics[i];
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void AnalysisEngine::update_frames(std::shared_ptr<RenderFrames> frames, double) {
+    PROFILE_ZONE("analyse");
+    this->time().restart();
+
+    Eigen::ArrayXf weights;
+    mpFlow::dtype::real sigma_ref;
+    std::shared_ptr<const RegionsOfInterest> regions;
+    quint64 mesh_generation;
+    {
+        QMutexLocker locker(&this->mutex_);
+        weights = this->weights_;
+        sigma_ref = this->sigma_ref_;
+        regions = this->regions_;
+        mesh_generation = this->mesh_generation_;
+    }
+    if ((frames == nullptr) || (frames->mesh_generation != mesh_generation) ||
+        (frames->data.rows() != weights.size())) {
+        return;
+    }
+
+    // analyse every frame of batch, not only the displayed ones, values are
+    // shifted by reference conductivity to avoid cancellation of the variance
+    auto results = std::make_shared<AnalysisResults>();
+    results->frames = frames;
+    results->statistics.resize(frames->data.cols());
+    for (mpFlow::dtype::index column = 0; column < frames->data.cols(); ++column) {
+        results->statistics[column] = StatisticsPipeline::evaluate(frames->data.col(column).data(),
+            weights.data(), weights.size(), sigma_ref);
+    }
+
+    // regional means of all frames with one sparse product
+    if ((regions != nullptr) && (regions->element_count() == frames->data.rows())) {
+        auto samples = std::make_shared<RegionSamples>();
+        samples->first_id = this->sample_id_;
+        samples->regions = regions;
+        samples->values = regions->apply(frames->data);
+        samples->timestamps.resize(frames->data.cols());
+        for (mpFlow::dtype::index column = 0; column < frames->data.cols(); ++column) {
+            samples->timestamps(column) = column < frames->timestamps.size() ?
+                HighPrecisionTime::wall_clock(frames->timestamps(column)) :
+                HighPrecisionTime::wall_clock(HighPrecisionTime::now());
+        }
+        this->sample_id_ += frames->data.cols();
+        results->regions = samples;
+    }
+
+    {
+        QMutexLocker locker(&this->mutex_);
+        this->recent_.push_front(results);
+        if (this->recent_.size() > recent_results) {
+            this->recent_.pop_back();
+        }
+    }
+
+    this->analyse_time() = this->time().elapsed();
+
+    if (results->regions != nullptr) {
+        emit this->regions_ready(results->regions);
+    }
+}
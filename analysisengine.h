@@ -0,0 +1,78 @@
+#ifndef ANALYSISENGINE_H
+#define ANALYSISENGINE_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <deque>
+#include <memory>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+#include "renderpreparer.h"
+#include "highprecisiontime.h"
+#include "regionsofinterest.h"
+#include "analysiskernels.h"
+
+// statistics computed for every frame, new kernels are added here and
+// show up in the analysis table and the mirror without further changes
+typedef analysis::Pipeline<
+    analysis::Min,
+    analysis::Max,
+    analysis::Mean,
+    analysis::StandardDeviation,
+    analysis::CoefficientOfVariation
+> StatisticsPipeline;
+
+// statistics of one frame in display units, one entry per pipeline kernel
+typedef StatisticsPipeline::Result FrameStatistics;
+
+// statistics of all frames of one prepared batch, one entry per column
+struct AnalysisResults {
+    std::shared_ptr<const RenderFrames> frames;
+    std::vector<FrameStatistics> statistics;
+    std::shared_ptr<const RegionSamples> regions;
+};
+
+// computes statistics of every reconstructed frame in its own thread with
+// one fused pass over the data, consumers look up the results of the frame
+// they display among the most recent batches
+class AnalysisEngine : public QObject {
+    Q_OBJECT
+public:
+    explicit AnalysisEngine(QObject* parent=nullptr);
+
+    void init(const Eigen::ArrayXf& element_area, mpFlow::dtype::real sigma_ref,
+        quint64 mesh_generation, std::shared_ptr<const RegionsOfInterest> regions=nullptr);
+    std::shared_ptr<const AnalysisResults> latest();
+
+    // statistics of given frame, false if its batch was not analysed (yet), frames are
+    // identified by acquisition time stamp, so renormalized copies of a batch are found too
+    bool statistics(const RenderFrames& frames, mpFlow::dtype::index column,
+        FrameStatistics* statistics);
+
+signals:
+    void regions_ready(std::shared_ptr<const RegionSamples> samples);
+
+public slots:
+    void update_frames(std::shared_ptr<RenderFrames> frames, double time_elapsed);
+
+public:
+    // accessors
+    QThread* thread() { return this->thread_; }
+    HighPrecisionTime& time() { return this->time_; }
+    double& analyse_time() { return this->analyse_time_; }
+
+private:
+    QThread* thread_;
+    QMutex mutex_;
+    HighPrecisionTime time_;
+    double analyse_time_;
+    Eigen::ArrayXf weights_;
+    mpFlow::dtype::real sigma_ref_;
+    std::shared_ptr<const RegionsOfInterest> regions_;
+    quint64 mesh_generation_;
+    quint64 sample_id_;
+    std::deque<std::shared_ptr<const AnalysisResults>> recent_;
+};
+
+#endif // ANALYSISENGINE_H
@@ -0,0 +1,180 @@
+#ifndef ANALYSISKERNELS_H
+#define ANALYSISKERNELS_H
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+
+// statistics are kernels, which declare the reductions they need and derive
+// their value from the accumulated reductions, a pipeline of kernels merges
+// all declared reductions at compile time and computes them in one fused
+// loop, so adding a statistic does not add another pass over the data
+namespace analysis {
+    // reductions a kernel can request, combined as bit flags
+    enum Reduction : unsigned {
+        sum = 1,
+        weighted_sum = 2,
+        min = 4,
+        max = 8,
+        square_sum = 16,
+        weighted_square_sum = 32
+    };
+
+    // accumulated reductions of values shifted by shift, weights are
+    // expected to be normalized, so weighted sums are means
+    struct Reductions {
+        double sum = 0.0;
+        double weighted_sum = 0.0;
+        double square_sum = 0.0;
+        double weighted_square_sum = 0.0;
+        float min = 0.0;
+        float max = 0.0;
+        mpFlow::dtype::index count = 0;
+        float shift = 0.0;
+    };
+
+    // fused loop over fixed size lanes, which eigen maps to simd registers,
+    // unrequested reductions are removed by the compiler, lane sums are
+    // folded into double accumulators after each chunk to bound rounding errors
+    template <
+        unsigned reductions
+    >
+    Reductions reduce(const float* values, const float* weights, mpFlow::dtype::index count,
+        float shift) {
+        typedef Eigen::Array<float, 8, 1> Lanes;
+        const mpFlow::dtype::index chunk_size = 4096;
+
+        Reductions result;
+        result.count = count;
+        result.shift = shift;
+        Lanes min = Lanes::Constant(std::numeric_limits<float>::max());
+        Lanes max = Lanes::Constant(std::numeric_limits<float>::lowest());
+        mpFlow::dtype::index vectorized = count / Lanes::SizeAtCompileTime * Lanes::SizeAtCompileTime;
+        for (mpFlow::dtype::index chunk = 0; chunk < vectorized; chunk += chunk_size) {
+            Lanes sum = Lanes::Zero(), weighted_sum = Lanes::Zero();
+            Lanes square_sum = Lanes::Zero(), weighted_square_sum = Lanes::Zero();
+            mpFlow::dtype::index end = std::min(chunk + chunk_size, vectorized);
+            for (mpFlow::dtype::index i = chunk; i < end; i += Lanes::SizeAtCompileTime) {
+                Eigen::Map<const Lanes> value(values + i);
+                Lanes deviation = value - shift;
+                if (reductions & Reduction::min) min = min.min(value);
+                if (reductions & Reduction::max) max = max.max(value);
+                if (reductions & Reduction::sum) sum += deviation;
+                if (reductions & Reduction::square_sum) square_sum += deviation * deviation;
+                if (reductions & (Reduction::weighted_sum | Reduction::weighted_square_sum)) {
+                    Lanes weighted = Eigen::Map<const Lanes>(weights + i) * deviation;
+                    if (reductions & Reduction::weighted_sum) weighted_sum += weighted;
+                    if (reductions & Reduction::weighted_square_sum) weighted_square_sum += weighted * deviation;
+                }
+            }
+            result.sum += sum.cast<double>().sum();
+            result.weighted_sum += weighted_sum.cast<double>().sum();
+            result.square_sum += square_sum.cast<double>().sum();
+            result.weighted_square_sum += weighted_square_sum.cast<double>().sum();
+        }
+
+        result.min = min.minCoeff();
+        result.max = max.maxCoeff();
+        // remaining values, weights are only read, when a kernel needs them
+        for (mpFlow::dtype::index i = vectorized; i < count; ++i) {
+            double deviation = values[i] - shift;
+            if (reductions & Reduction::min) result.min = std::min(result.min, values[i]);
+            if (reductions & Reduction::max) result.max = std::max(result.max, values[i]);
+            if (reductions & Reduction::sum) result.sum += deviation;
+            if (reductions & Reduction::square_sum) result.square_sum += deviation * deviation;
+            if (reductions & Reduction::weighted_sum) result.weighted_sum += weights[i] * deviation;
+            if (reductions & Reduction::weighted_square_sum) {
+                result.weighted_square_sum += weights[i] * deviation * deviation;
+            }
+        }
+
+        return result;
+    }
+
+    // standard statistics of reconstructed conductivity, weighted by element area
+    struct Min {
+        static const unsigned reductions = Reduction::min;
+        static const char* name() { return "min"; }
+        static const char* unit() { return "mS"; }
+        static float evaluate(const Reductions& r) { return r.min * 1e3; }
+    };
+
+    struct Max {
+        static const unsigned reductions = Reduction::max;
+        static const char* name() { return "max"; }
+        static const char* unit() { return "mS"; }
+        static float evaluate(const Reductions& r) { return r.max * 1e3; }
+    };
+
+    struct Mean {
+        static const unsigned reductions = Reduction::weighted_sum;
+        static const char* name() { return "mean value"; }
+        static const char* unit() { return "mS"; }
+        static float evaluate(const Reductions& r) { return (r.weighted_sum + r.shift) * 1e3; }
+    };
+
+    struct StandardDeviation {
+        static const unsigned reductions = Reduction::weighted_sum | Reduction::weighted_square_sum;
+        static const char* name() { return "standard deviation"; }
+        static const char* unit() { return "mS"; }
+        static float evaluate(const Reductions& r) {
+            return std::sqrt(std::max(r.weighted_square_sum - r.weighted_sum * r.weighted_sum, 0.0)) * 1e3;
+        }
+    };
+
+    struct CoefficientOfVariation {
+        static const unsigned reductions = Mean::reductions | StandardDeviation::reductions;
+        static const char* name() { return "coefficient of variation"; }
+        static const char* unit() { return "%"; }
+        static float evaluate(const Reductions& r) {
+            return StandardDeviation::evaluate(r) / Mean::evaluate(r) * 100.0;
+        }
+    };
+
+    // union of reductions of all kernels
+    template <
+        class... kernels
+    >
+    struct combined_reductions;
+
+    template <>
+    struct combined_reductions<> {
+        static const unsigned value = 0;
+    };
+
+    template <
+        class kernel,
+        class... kernels
+    >
+    struct combined_reductions<kernel, kernels...> {
+        static const unsigned value = kernel::reductions | combined_reductions<kernels...>::value;
+    };
+
+    // fixed list of kernels evaluated from one fused reduction
+    template <
+        class... kernels
+    >
+    struct Pipeline {
+        static const unsigned reductions = combined_reductions<kernels...>::value;
+        static const size_t size = sizeof...(kernels);
+        typedef std::array<float, sizeof...(kernels)> Result;
+
+        static std::array<const char*, sizeof...(kernels)> names() {
+            return {{ kernels::name()... }};
+        }
+        static std::array<const char*, sizeof...(kernels)> units() {
+            return {{ kernels::unit()... }};
+        }
+
+        static Result evaluate(const float* values, const float* weights,
+            mpFlow::dtype::index count, float shift) {
+            Reductions result = reduce<reductions>(values, weights, count, shift);
+            return {{ kernels::evaluate(result)... }};
+        }
+    };
+}
+
+#endif // ANALYSISKERNELS_H
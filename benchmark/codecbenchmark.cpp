@@ -0,0 +1,139 @@
+#include <QCoreApplication>
+#include <QtConcurrent>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include "framecodec.h"
+#include "logreader.h"
+#include "highprecisiontime.h"
+
+// usage: codecbenchmark [recording.log]
+//
+// compresses all frames of given recording, or of a synthetic breathing
+// sequence, block wise with one and with all threads and reports the
+// compression ratio and the throughput of raw frame data in MB/s
+struct Block {
+    Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps;
+    Eigen::ArrayXXf frames;
+    QByteArray data;
+    Eigen::Array<qint64, Eigen::Dynamic, 1> decoded_timestamps;
+    Eigen::ArrayXXf decoded_frames;
+};
+
+static void synthetic_frames(mpFlow::dtype::index rows, mpFlow::dtype::index count,
+    Eigen::Array<qint64, Eigen::Dynamic, 1>& timestamps, Eigen::ArrayXXf& frames) {
+    // smooth spatial pattern modulated by breathing and heart beat plus noise
+    Eigen::ArrayXf position = Eigen::ArrayXf::LinSpaced(rows, 0.0, 1.0);
+    Eigen::ArrayXf lungs = (position * 6.0 * M_PI).sin().abs();
+    Eigen::ArrayXf heart = (-(position - 0.5).square() * 200.0).exp();
+    timestamps.resize(count);
+    frames.resize(rows, count);
+    for (mpFlow::dtype::index frame = 0; frame < count; ++frame) {
+        double time = frame / 50.0;
+        timestamps(frame) = (qint64)(time * 1e3);
+        frames.col(frame) = 1.0 + 0.05 * lungs * std::sin(2.0 * M_PI * 0.25 * time) +
+            0.01 * heart * std::sin(2.0 * M_PI * 1.2 * time) +
+            1e-4 * Eigen::ArrayXf::Random(rows);
+    }
+}
+
+static double run(std::vector<Block>& blocks, bool parallel, bool compress) {
+    auto process = [=](Block& block) {
+        if (compress) {
+            block.data = FrameCodec::compress(block.timestamps, block.frames);
+        } else {
+            block.decoded_timestamps.resize(block.timestamps.size());
+            block.decoded_frames.resize(block.frames.rows(), block.frames.cols());
+            FrameCodec::decompress(block.data, block.decoded_timestamps, block.decoded_frames);
+        }
+    };
+
+    HighPrecisionTime time;
+    if (parallel) {
+        QtConcurrent::blockingMap(blocks, process);
+    } else {
+        for (auto& block : blocks) {
+            process(block);
+        }
+    }
+    return time.elapsed();
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+
+    // load recording or create synthetic frames
+    Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps;
+    Eigen::ArrayXXf frames;
+    QString source = "synthetic";
+    if (argc > 1) {
+        LogReader reader;
+        if (!reader.open(argv[1])) {
+            std::fprintf(stderr, "cannot open recording %s\n", argv[1]);
+            return 1;
+        }
+        frames = reader.frames(0, reader.frame_count());
+        timestamps.resize(reader.frame_count());
+        for (mpFlow::dtype::index frame = 0; frame < reader.frame_count(); ++frame) {
+            timestamps(frame) = reader.timestamp(frame);
+        }
+        source = argv[1];
+    } else {
+        synthetic_frames(10000, 3000, timestamps, frames);
+    }
+    if (frames.cols() == 0) {
+        std::fprintf(stderr, "no frames\n");
+        return 1;
+    }
+
+    // split into blocks of the same size as used by log writer
+    mpFlow::dtype::index frames_per_block = std::max((size_t)1,
+        (size_t)(4 * 1024 * 1024) / (sizeof(qint64) + sizeof(float) * frames.rows()));
+    std::vector<Block> blocks;
+    for (mpFlow::dtype::index frame = 0; frame < frames.cols(); frame += frames_per_block) {
+        mpFlow::dtype::index count = std::min(frames_per_block,
+            (mpFlow::dtype::index)frames.cols() - frame);
+        Block block;
+        block.timestamps = timestamps.segment(frame, count);
+        block.frames = frames.middleCols(frame, count);
+        blocks.push_back(block);
+    }
+
+    // measure all combinations
+    double raw_size = sizeof(float) * frames.size() + sizeof(qint64) * timestamps.size();
+    double compress_single = run(blocks, false, true);
+    double compress_parallel = run(blocks, true, true);
+    double decompress_single = run(blocks, false, false);
+    double decompress_parallel = run(blocks, true, false);
+
+    // verify lossless round trip
+    double compressed_size = 0.0;
+    bool lossless = true;
+    for (const auto& block : blocks) {
+        compressed_size += block.data.size();
+        lossless &= (block.decoded_timestamps == block.timestamps).all() &&
+            (std::memcmp(block.decoded_frames.data(), block.frames.data(),
+                sizeof(float) * block.frames.size()) == 0);
+    }
+    double recording_time = (timestamps(timestamps.size() - 1) - timestamps(0)) * 1e-3;
+
+    std::printf("source: %s\n", source.toLocal8Bit().constData());
+    std::printf("frames: %ld\n", (long)frames.cols());
+    std::printf("values per frame: %ld\n", (long)frames.rows());
+    std::printf("blocks: %ld\n", (long)blocks.size());
+    std::printf("threads: %d\n", QThread::idealThreadCount());
+    std::printf("lossless: %s\n", lossless ? "yes" : "no");
+    std::printf("compression ratio: %.3f\n", raw_size / compressed_size);
+    std::printf("compress single thread: %.1f MB/s\n", raw_size / compress_single * 1e-6);
+    std::printf("compress parallel: %.1f MB/s\n", raw_size / compress_parallel * 1e-6);
+    std::printf("decompress single thread: %.1f MB/s\n", raw_size / decompress_single * 1e-6);
+    std::printf("decompress parallel: %.1f MB/s\n", raw_size / decompress_parallel * 1e-6);
+    if (recording_time > 0.0) {
+        std::printf("decompress realtime factor: %.1f\n", recording_time / decompress_parallel);
+    }
+
+    return lossless ? 0 : 1;
+}
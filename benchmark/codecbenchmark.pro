@@ -0,0 +1,38 @@
+#-------------------------------------------------
+#
+# Benchmark of lossless frame compression on recorded
+# or synthetic conductivity frames
+#
+#-------------------------------------------------
+
+QT       += core concurrent
+QT       -= gui
+
+TARGET = codecbenchmark
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += codecbenchmark.cpp \
+    ../framecodec.cpp \
+    ../logreader.cpp \
+    ../highprecisiontime.cpp
+
+HEADERS += ../framecodec.h \
+    ../logreader.h \
+    ../logformat.h \
+    ../highprecisiontime.h
+
+QMAKE_CXXFLAGS += -O3
+
+macx {
+    QMAKE_LIBS += -lc++
+    QMAKE_CXXFLAGS += -mmacosx-version-min=10.7
+}
+
+INCLUDEPATH += /usr/local/cuda/include
+INCLUDEPATH += /usr/local/include
+INCLUDEPATH += /usr/local/include/eigen3
+INCLUDEPATH += /usr/include/eigen3
@@ -0,0 +1,162 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QFile>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// usage: mirrorloadtest [--host localhost] [--port 3003] [--clients 200]
+//     [--format u8] [--delta] [--slow 0.1] [--duration 30] [--pid <viewer pid>]
+//
+// opens many /stream connections to a running viewer, a fraction of them
+// reads only a few kilobytes per second to simulate bad links. Once per
+// second client side throughput, server side per client statistics, the gui
+// frame time reported by the viewer and, if its pid is given, its resident
+// memory are printed, which all should stay flat independent of slow clients
+class Client : public QObject {
+public:
+    Client(const QString& host, quint16 port, const QString& path, bool slow) :
+        received_(0), slow_(slow) {
+        this->socket_.connectToHost(host, port);
+        connect(&this->socket_, &QTcpSocket::connected, [=]() {
+            this->socket_.write(QString("GET %1 HTTP/1.1\r\nHost: %2\r\n\r\n")
+                .arg(path, host).toUtf8());
+        });
+
+        // slow clients keep a tiny receive buffer and drain it periodically,
+        // so tcp flow control pushes back to the server
+        if (this->slow_) {
+            this->socket_.setReadBufferSize(4096);
+            connect(&this->timer_, &QTimer::timeout, [=]() {
+                this->received_ += this->socket_.read(1024).size();
+            });
+            this->timer_.start(100);
+        } else {
+            connect(&this->socket_, &QTcpSocket::readyRead, [=]() {
+                this->received_ += this->socket_.readAll().size();
+            });
+        }
+    }
+
+    qint64 received() { return this->received_; }
+    bool connected() { return this->socket_.state() == QAbstractSocket::ConnectedState; }
+
+private:
+    QTcpSocket socket_;
+    QTimer timer_;
+    qint64 received_;
+    bool slow_;
+};
+
+static long resident_memory(const QString& pid) {
+    QFile status("/proc/" + pid + "/status");
+    if (pid.isEmpty() || !status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+    for (const auto& line : QString(status.readAll()).split('\n')) {
+        if (line.startsWith("VmRSS:")) {
+            return line.section(' ', 1, -1, QString::SectionSkipEmpty).section(' ', 0, 0).toLong();
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("host", "viewer host", "host", "localhost"));
+    parser.addOption(QCommandLineOption("port", "mirror server port", "port", "3003"));
+    parser.addOption(QCommandLineOption("clients", "number of stream clients", "count", "200"));
+    parser.addOption(QCommandLineOption("format", "stream format f32, u8 or u16", "format", "u8"));
+    parser.addOption(QCommandLineOption("delta", "request delta coded frames"));
+    parser.addOption(QCommandLineOption("slow", "fraction of slow clients", "fraction", "0.1"));
+    parser.addOption(QCommandLineOption("duration", "test duration in seconds", "seconds", "30"));
+    parser.addOption(QCommandLineOption("pid", "viewer pid for memory statistics", "pid"));
+    parser.process(application);
+
+    QString host = parser.value("host");
+    quint16 port = parser.value("port").toUShort();
+    int client_count = parser.value("clients").toInt();
+    double slow = parser.value("slow").toDouble();
+    QString path = "/stream?format=" + parser.value("format") +
+        (parser.isSet("delta") ? "&delta=1" : "");
+    QString base_url = QString("http://%1:%2").arg(host).arg(port);
+
+    // slow clients are spread evenly over all clients
+    std::vector<std::unique_ptr<Client>> clients;
+    int slow_clients = 0;
+    for (int client = 0; client < client_count; ++client) {
+        bool is_slow = (int)((client + 1) * slow) > slow_clients;
+        slow_clients += is_slow ? 1 : 0;
+        clients.push_back(std::unique_ptr<Client>(new Client(host, port, path, is_slow)));
+    }
+
+    // poll server side statistics and gui frame time once per second
+    QNetworkAccessManager network;
+    QJsonObject stats;
+    QString gui_frame_time = "n/a";
+    auto poll = [&]() {
+        QNetworkReply* stats_reply = network.get(QNetworkRequest(QUrl(base_url + "/stats")));
+        QObject::connect(stats_reply, &QNetworkReply::finished, [&, stats_reply]() {
+            stats = QJsonDocument::fromJson(stats_reply->readAll()).object();
+            stats_reply->deleteLater();
+        });
+        QNetworkReply* analysis_reply = network.get(QNetworkRequest(QUrl(base_url + "/analysis-update")));
+        QObject::connect(analysis_reply, &QNetworkReply::finished, [&, analysis_reply]() {
+            for (const auto& analysis : QJsonDocument::fromJson(analysis_reply->readAll())
+                .object()["analysis"].toArray()) {
+                if (analysis.toObject()["name"].toString() == "gui frame time:") {
+                    gui_frame_time = analysis.toObject()["result"].toString();
+                }
+            }
+            analysis_reply->deleteLater();
+        });
+    };
+
+    int second = 0;
+    qint64 last_received = 0;
+    QTimer report;
+    QObject::connect(&report, &QTimer::timeout, [&]() {
+        second += 1;
+        qint64 received = 0;
+        int connected = 0;
+        for (const auto& client : clients) {
+            received += client->received();
+            connected += client->connected() ? 1 : 0;
+        }
+
+        double dropped = 0.0, lag = 0.0, queued = 0.0;
+        for (const auto& subscriber : stats["subscribers"].toArray()) {
+            dropped += subscriber.toObject()["dropped_frames"].toDouble();
+            lag = std::max(lag, subscriber.toObject()["lag"].toDouble());
+            queued += subscriber.toObject()["queued_frames"].toDouble();
+        }
+
+        std::printf("time: %d s, connected: %d, received: %.2f MB/s, dropped frames: %.0f, "
+            "max lag: %.0f, queued frames: %.0f, rejected: %.0f, gui frame time: %s, rss: %ld kB\n",
+            second, connected, (received - last_received) * 1e-6, dropped, lag, queued,
+            stats["rejected_subscribers"].toDouble(), gui_frame_time.toLocal8Bit().constData(),
+            resident_memory(parser.value("pid")));
+        std::fflush(stdout);
+        last_received = received;
+
+        if (second >= parser.value("duration").toInt()) {
+            application.quit();
+        }
+        poll();
+    });
+    report.start(1000);
+    poll();
+
+    return application.exec();
+}
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Load test of the mirror server with many simulated
+# local stream clients
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = mirrorloadtest
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += mirrorloadtest.cpp
+
+QMAKE_CXXFLAGS += -O3
+
+macx {
+    QMAKE_LIBS += -lc++
+    QMAKE_CXXFLAGS += -mmacosx-version-min=10.7
+}
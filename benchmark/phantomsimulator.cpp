@@ -0,0 +1,173 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QUdpSocket>
+#include <QDataStream>
+#include <QFile>
+#include <QJsonDocument>
+#include <QThreadPool>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include "forwardsimulator.h"
+
+// usage: phantomsimulator --config <solver config> [--phantom breathing]
+//     [--rate 25] [--noise 0] [--duration 30] [--host 127.0.0.1] [--port 3002]
+//     [--threads 0] [--tolerance 1e-6] [--no-send]
+//
+// simulates measurements of a time varying conductivity phantom on the cpu
+// with the mesh, electrodes and patterns of a solver config and sends them
+// as measurement datagrams to the viewer, so reconstruction speed and
+// accuracy can be checked against a known ground truth without hardware.
+// Once per second the achieved frame rate, simulation time and mean cg
+// iterations are printed, with rate 0 frames are simulated as fast as possible
+static double phantom(const QString& name, double x, double y, double time) {
+    // coordinates are relative to mesh radius, ventral side is positive y
+    if (name == "moving") {
+        // well conducting inclusion orbiting once every 8 s
+        double angle = 2.0 * M_PI * time / 8.0;
+        double dx = x - 0.5 * std::cos(angle), dy = y - 0.5 * std::sin(angle);
+        return dx * dx + dy * dy < 0.2 * 0.2 ? 2.0 : 1.0;
+    } else if (name == "breathing") {
+        // both lungs lose conductivity during inspiration every 4 s, heart pulses with 72 bpm
+        double lungs = std::exp(-((std::abs(x) - 0.4) * (std::abs(x) - 0.4) + y * y) / 0.05);
+        double heart = std::exp(-(x * x + (y - 0.3) * (y - 0.3)) / 0.01);
+        return 1.0 - 0.3 * lungs * (0.5 - 0.5 * std::cos(2.0 * M_PI * time / 4.0)) +
+            0.1 * heart * (0.5 - 0.5 * std::cos(2.0 * M_PI * time * 1.2));
+    }
+    return 1.0;
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("config", "solver config file", "file"));
+    parser.addOption(QCommandLineOption("phantom", "breathing, moving or homogeneous", "name", "breathing"));
+    parser.addOption(QCommandLineOption("rate", "frames per second, 0 for unlimited", "rate", "25"));
+    parser.addOption(QCommandLineOption("noise", "relative standard deviation of measurement noise",
+        "fraction", "0"));
+    parser.addOption(QCommandLineOption("duration", "simulation duration in seconds", "seconds", "30"));
+    parser.addOption(QCommandLineOption("host", "viewer host", "host", "127.0.0.1"));
+    parser.addOption(QCommandLineOption("port", "measurement system port", "port", "3002"));
+    parser.addOption(QCommandLineOption("threads", "solver threads, 0 for all cores", "count", "0"));
+    parser.addOption(QCommandLineOption("tolerance", "relative cg residual", "tolerance", "1e-6"));
+    parser.addOption(QCommandLineOption("no-send", "only simulate, do not send datagrams"));
+    parser.process(application);
+
+    // read json config
+    QFile file(parser.value("config"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "cannot open config: %s\n", parser.value("config").toLocal8Bit().constData());
+        return 1;
+    }
+    auto config = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    if (parser.value("threads").toInt() > 0) {
+        QThreadPool::globalInstance()->setMaxThreadCount(parser.value("threads").toInt());
+    }
+
+    // create same mesh and electrodes as viewer does
+    auto mesh = meshgenerator::createMeshFromConfig(config["model"].toObject()["mesh"].toObject());
+    std::unique_ptr<ForwardSimulator> simulator_instance;
+    try {
+        simulator_instance.reset(new ForwardSimulator(config, std::get<0>(mesh), std::get<1>(mesh),
+            std::get<2>(mesh), meshgenerator::createElectrodesFromConfig(config["model"].toObject()),
+            1.0, parser.value("tolerance").toDouble()));
+    } catch (const std::invalid_argument& e) {
+        std::fprintf(stderr, "invalid config: %s\n", e.what());
+        return 1;
+    }
+    ForwardSimulator& simulator = *simulator_instance;
+    std::fprintf(stderr, "mesh: %ld nodes, %ld elements, %ld electrodes, %ld x %ld measurements\n",
+        (long)simulator.nodes().rows(), (long)simulator.elements().rows(),
+        (long)simulator.electrode_count(), (long)simulator.measurement_count(),
+        (long)simulator.drive_count());
+
+    typedef std::chrono::steady_clock clock;
+    QUdpSocket socket;
+    QHostAddress address(parser.value("host"));
+    quint16 port = parser.value("port").toUShort();
+    double rate = std::max(0.0, parser.value("rate").toDouble());
+    double noise = parser.value("noise").toDouble();
+    double duration = parser.value("duration").toDouble();
+    QString phantom_name = parser.value("phantom");
+    std::mt19937 generator(42);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    Eigen::ArrayXd sigma(simulator.elements().rows());
+    clock::time_point start = clock::now(), report = start;
+    double simulation_time = 0.0, max_simulation_time = 0.0, iterations = 0.0;
+    long frames = 0, late = 0, last_frames = 0, last_factorizations = 0;
+    for (long frame = 0; ; ++frame) {
+        // phantom time follows frame count, so slow simulations stay consistent
+        double time = rate > 0.0 ? frame / rate :
+            std::chrono::duration<double>(clock::now() - start).count();
+        if (time >= duration) {
+            break;
+        }
+        if (rate > 0.0) {
+            clock::time_point due = start + std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>(time));
+            if (clock::now() > due) {
+                late += 1;
+            } else {
+                std::this_thread::sleep_until(due);
+            }
+        }
+
+        // simulate measurement of phantom
+        clock::time_point begin = clock::now();
+        for (Eigen::Index element = 0; element < sigma.rows(); ++element) {
+            sigma(element) = simulator.sigma_ref() * phantom(phantom_name,
+                simulator.element_centers()(element, 0) / simulator.radius(),
+                simulator.element_centers()(element, 1) / simulator.radius(), time);
+        }
+        Eigen::ArrayXXf measurement = simulator.solve(sigma);
+        if (noise > 0.0) {
+            float scale = noise * measurement.abs().maxCoeff();
+            measurement = measurement.unaryExpr([&](float value) {
+                return value + scale * normal(generator);
+            });
+        }
+        double elapsed = std::chrono::duration<double>(clock::now() - begin).count();
+        simulation_time += elapsed;
+        max_simulation_time = std::max(max_simulation_time, elapsed);
+        iterations += simulator.iterations();
+        frames += 1;
+
+        // serialize measurement like the device does
+        if (!parser.isSet("no-send")) {
+            QByteArray datagram;
+            QDataStream output_stream(&datagram, QIODevice::WriteOnly);
+            output_stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+            for (Eigen::Index row = 0; row < measurement.rows(); ++row)
+            for (Eigen::Index column = 0; column < measurement.cols(); ++column) {
+                output_stream << measurement(row, column);
+            }
+            socket.writeDatagram(datagram, address, port);
+        }
+
+        if (clock::now() - report >= std::chrono::seconds(1)) {
+            double interval = std::chrono::duration<double>(clock::now() - report).count();
+            std::printf("time: %.1f s, frames: %.1f 1/s, simulation: %.2f ms (max %.2f ms), "
+                "cg iterations: %.1f, factorizations: %ld, late frames: %ld\n",
+                time, (frames - last_frames) / interval,
+                simulation_time / (frames - last_frames) * 1e3, max_simulation_time * 1e3,
+                iterations / (frames - last_frames), simulator.factorizations() - last_factorizations,
+                late);
+            std::fflush(stdout);
+            report = clock::now();
+            last_frames = frames;
+            last_factorizations = simulator.factorizations();
+            simulation_time = max_simulation_time = iterations = 0.0;
+        }
+    }
+
+    return 0;
+}
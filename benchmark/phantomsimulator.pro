@@ -0,0 +1,38 @@
+#-------------------------------------------------
+#
+# Cpu forward simulation of phantoms sending
+# measurement datagrams to the viewer
+#
+#-------------------------------------------------
+
+QT       += core network concurrent
+QT       -= gui
+
+TARGET = phantomsimulator
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += phantomsimulator.cpp \
+    ../forwardsimulator.cpp \
+    ../meshgenerator.cpp
+
+HEADERS += ../forwardsimulator.h \
+    ../meshgenerator.h
+
+QMAKE_CXXFLAGS += -O3
+
+macx {
+    QMAKE_LIBS += -lc++
+    QMAKE_CXXFLAGS += -mmacosx-version-min=10.7
+}
+
+unix:!symbian: LIBS += -L/usr/local/lib -ldistmesh
+QMAKE_LIBS += -Wl,-rpath=/usr/local/lib
+
+INCLUDEPATH += /usr/local/cuda/include
+INCLUDEPATH += /usr/local/include
+INCLUDEPATH += /usr/local/include/eigen3
+INCLUDEPATH += /usr/include/eigen3
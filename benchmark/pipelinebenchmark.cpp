@@ -0,0 +1,381 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDataStream>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QThread>
+#include <QFile>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include <Eigen/Sparse>
+#include "renderpreparer.h"
+#include "analysisengine.h"
+#include "regionsofinterest.h"
+#include "logwriter.h"
+#include "mirrorencoder.h"
+#include "colormap.h"
+#include "highprecisiontime.h"
+
+// usage: pipelinebenchmark [--rings 10,40,100,250] [--electrodes 16] [--batch 16]
+//     [--min-time 0.5] [--max-matrix 1024] [--output results.json]
+//
+// runs every hot path of the viewer on the cpu over synthetic circular meshes
+// of increasing size: datagram decode, measurement batching, reconstruction,
+// node averaging and coloring, analysis reductions, log writing and mirror
+// serialization. Results are written as json, one entry per benchmark and
+// mesh, for regression tracking across builds
+struct Mesh {
+    mpFlow::dtype::index rings;
+    Eigen::ArrayXXf nodes;
+    Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic> elements;
+    Eigen::ArrayXXf electrodes;
+    Eigen::ArrayXf element_area;
+    Eigen::SparseMatrix<float, Eigen::RowMajor> node_averaging;
+};
+
+static Mesh circular_mesh(mpFlow::dtype::index rings, mpFlow::dtype::index electrode_count) {
+    // unit disc of concentric rings, ring k holds 6 k nodes, which gives
+    // 6 rings^2 evenly sized elements
+    Mesh mesh;
+    mesh.rings = rings;
+    mesh.nodes = Eigen::ArrayXXf::Zero(2, 1 + 3 * rings * (rings + 1));
+    std::vector<mpFlow::dtype::index> ring_start(rings + 1, 0);
+    mpFlow::dtype::index node = 1;
+    for (mpFlow::dtype::index ring = 1; ring <= rings; ++ring) {
+        ring_start[ring] = node;
+        for (mpFlow::dtype::index i = 0; i < 6 * ring; ++i, ++node) {
+            double angle = 2.0 * M_PI * i / (6 * ring);
+            mesh.nodes(0, node) = (double)ring / rings * std::cos(angle);
+            mesh.nodes(1, node) = (double)ring / rings * std::sin(angle);
+        }
+    }
+
+    // stitch neighbouring rings by walking around both of them by angle
+    std::vector<std::array<mpFlow::dtype::index, 3>> triangles;
+    for (mpFlow::dtype::index ring = 1; ring <= rings; ++ring) {
+        mpFlow::dtype::index inner_count = ring == 1 ? 1 : 6 * (ring - 1);
+        mpFlow::dtype::index outer_count = 6 * ring;
+        auto inner = [&](mpFlow::dtype::index i) {
+            return ring == 1 ? 0 : ring_start[ring - 1] + i % inner_count;
+        };
+        auto outer = [&](mpFlow::dtype::index i) { return ring_start[ring] + i % outer_count; };
+        mpFlow::dtype::index i = 0, o = 0;
+        while ((o < outer_count) || ((ring > 1) && (i < inner_count))) {
+            bool advance_outer = (ring == 1) || (i >= inner_count) || ((o < outer_count) &&
+                ((double)(o + 1) / outer_count <= (double)(i + 1) / inner_count));
+            if (advance_outer) {
+                triangles.push_back({{ inner(i), outer(o), outer(o + 1) }});
+                o += 1;
+            } else {
+                triangles.push_back({{ inner(i), outer(o), inner(i + 1) }});
+                i += 1;
+            }
+        }
+    }
+    mesh.elements.resize(triangles.size(), 3);
+    for (mpFlow::dtype::index element = 0; element < triangles.size(); ++element)
+    for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+        mesh.elements(element, node) = triangles[element][node];
+    }
+
+    // evenly spaced electrodes on the boundary given by start and end point
+    mesh.electrodes.resize(4, electrode_count);
+    for (mpFlow::dtype::index electrode = 0; electrode < electrode_count; ++electrode) {
+        double angle = 2.0 * M_PI * electrode / electrode_count;
+        double width = M_PI / electrode_count;
+        mesh.electrodes.col(electrode) << std::cos(angle - 0.5 * width), std::sin(angle - 0.5 * width),
+            std::cos(angle + 0.5 * width), std::sin(angle + 0.5 * width);
+    }
+
+    // area weighted node averaging the same way as Image::init
+    mesh.element_area = Eigen::ArrayXf::Zero(mesh.elements.rows());
+    Eigen::ArrayXf node_area = Eigen::ArrayXf::Zero(mesh.nodes.cols());
+    for (mpFlow::dtype::index element = 0; element < mesh.elements.rows(); ++element) {
+        Eigen::Array2f a = mesh.nodes.col(mesh.elements(element, 0));
+        Eigen::Array2f b = mesh.nodes.col(mesh.elements(element, 1));
+        Eigen::Array2f c = mesh.nodes.col(mesh.elements(element, 2));
+        mesh.element_area(element) = 0.5 * std::abs(
+            (b(0) - a(0)) * (c(1) - a(1)) - (c(0) - a(0)) * (b(1) - a(1)));
+        for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+            node_area(mesh.elements(element, node)) += mesh.element_area(element);
+        }
+    }
+    std::vector<Eigen::Triplet<float>> weights;
+    weights.reserve(mesh.elements.rows() * 3);
+    for (mpFlow::dtype::index element = 0; element < mesh.elements.rows(); ++element)
+    for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+        weights.push_back(Eigen::Triplet<float>(mesh.elements(element, node), element,
+            mesh.element_area(element) / node_area(mesh.elements(element, node))));
+    }
+    mesh.node_averaging.resize(mesh.nodes.cols(), mesh.elements.rows());
+    mesh.node_averaging.setFromTriplets(weights.begin(), weights.end());
+
+    return mesh;
+}
+
+static Eigen::ArrayXXf breathing_frames(const Mesh& mesh, mpFlow::dtype::index count,
+    mpFlow::dtype::real sigma_ref) {
+    // both lungs change their conductivity in a breathing cycle
+    Eigen::ArrayXXf frames(mesh.elements.rows(), count);
+    for (mpFlow::dtype::index element = 0; element < mesh.elements.rows(); ++element) {
+        float x = (mesh.nodes(0, mesh.elements(element, 0)) + mesh.nodes(0, mesh.elements(element, 1)) +
+            mesh.nodes(0, mesh.elements(element, 2))) / 3.0;
+        float y = (mesh.nodes(1, mesh.elements(element, 0)) + mesh.nodes(1, mesh.elements(element, 1)) +
+            mesh.nodes(1, mesh.elements(element, 2))) / 3.0;
+        float lungs = std::exp(-((std::abs(x) - 0.4) * (std::abs(x) - 0.4) + y * y) / 0.05);
+        for (mpFlow::dtype::index frame = 0; frame < count; ++frame) {
+            frames(element, frame) = sigma_ref * (1.0 - 0.3 * lungs *
+                (0.5 + 0.5 * std::sin(2.0 * M_PI * frame / count)));
+        }
+    }
+    return frames;
+}
+
+struct Result {
+    QString benchmark;
+    const Mesh* mesh;
+    double items;
+    double bytes;
+    std::vector<double> times;
+};
+
+// repeats function until minimal time has passed, items and bytes are processed per call
+static Result measure(const QString& benchmark, const Mesh& mesh, double min_time,
+    double items, double bytes, std::function<void()> function) {
+    Result result = { benchmark, &mesh, items, bytes, std::vector<double>() };
+
+    // one warm up call fills caches and lazy allocations
+    function();
+
+    HighPrecisionTime total, time;
+    while ((result.times.size() < 3) || (total.elapsed() < min_time)) {
+        time.restart();
+        function();
+        result.times.push_back(time.elapsed());
+    }
+    std::sort(result.times.begin(), result.times.end());
+
+    return result;
+}
+
+static QJsonObject to_json(const Result& result, mpFlow::dtype::index electrodes,
+    mpFlow::dtype::index batch) {
+    double sum = 0.0;
+    for (auto time : result.times) {
+        sum += time;
+    }
+    double mean = sum / result.times.size();
+    double median = result.times[result.times.size() / 2];
+
+    QJsonObject json;
+    json["benchmark"] = result.benchmark;
+    json["rings"] = (double)result.mesh->rings;
+    json["nodes"] = (double)result.mesh->nodes.cols();
+    json["elements"] = (double)result.mesh->elements.rows();
+    json["electrodes"] = (double)electrodes;
+    json["batch"] = (double)batch;
+    json["iterations"] = (double)result.times.size();
+    json["min_ms"] = result.times.front() * 1e3;
+    json["median_ms"] = median * 1e3;
+    json["mean_ms"] = mean * 1e3;
+    json["max_ms"] = result.times.back() * 1e3;
+    json["items_per_second"] = result.items / median;
+    json["megabytes_per_second"] = result.bytes / median * 1e-6;
+    return json;
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("rings", "comma separated mesh ring counts", "rings",
+        "10,40,100,250"));
+    parser.addOption(QCommandLineOption("electrodes", "number of electrodes", "count", "16"));
+    parser.addOption(QCommandLineOption("batch", "frames per measurement batch", "count", "16"));
+    parser.addOption(QCommandLineOption("min-time", "minimal run time per benchmark in s",
+        "seconds", "0.5"));
+    parser.addOption(QCommandLineOption("max-matrix", "largest reconstruction matrix in MB",
+        "megabytes", "1024"));
+    parser.addOption(QCommandLineOption("output", "json result file, default is stdout", "file"));
+    parser.process(application);
+
+    mpFlow::dtype::index electrode_count = parser.value("electrodes").toInt();
+    mpFlow::dtype::index batch = std::max(1, parser.value("batch").toInt());
+    double min_time = parser.value("min-time").toDouble();
+    double max_matrix = parser.value("max-matrix").toDouble() * 1024.0 * 1024.0;
+    mpFlow::dtype::real sigma_ref = 0.1;
+
+    // one datagram holds all measurements of one frame, electrodes x electrodes values
+    mpFlow::dtype::index measurement_rows = electrode_count;
+    mpFlow::dtype::index measurement_columns = electrode_count;
+    mpFlow::dtype::index measurement_count = measurement_rows * measurement_columns;
+
+    QTemporaryDir temporary_dir;
+    QJsonArray results;
+    for (const auto& rings_value : parser.value("rings").split(',', QString::SkipEmptyParts)) {
+        Mesh mesh = circular_mesh(rings_value.toInt(), electrode_count);
+        Eigen::ArrayXXf frames = breathing_frames(mesh, batch, sigma_ref);
+        std::fprintf(stderr, "mesh with %d rings: %ld nodes, %ld elements\n", rings_value.toInt(),
+            (long)mesh.nodes.cols(), (long)mesh.elements.rows());
+        std::vector<Result> mesh_results;
+
+        // big endian datagrams as sent by the measurement system
+        std::vector<QByteArray> datagrams(batch);
+        for (auto& datagram : datagrams) {
+            QDataStream output(&datagram, QIODevice::WriteOnly);
+            output.setFloatingPointPrecision(QDataStream::SinglePrecision);
+            Eigen::ArrayXf values = Eigen::ArrayXf::Random(measurement_count);
+            for (mpFlow::dtype::index i = 0; i < measurement_count; ++i) {
+                output << values(i);
+            }
+        }
+        double datagram_bytes = sizeof(float) * measurement_count * batch;
+
+        // decode each datagram the same way as MeasurementSystem::readyRead
+        Eigen::ArrayXXf measurement(measurement_rows, measurement_columns);
+        mesh_results.push_back(measure("datagram_decode", mesh, min_time, batch, datagram_bytes, [&]() {
+            for (const auto& datagram : datagrams) {
+                QDataStream input(datagram);
+                input.setFloatingPointPrecision(QDataStream::SinglePrecision);
+                for (mpFlow::dtype::index row = 0; row < measurement_rows; ++row)
+                for (mpFlow::dtype::index column = 0; column < measurement_columns; ++column) {
+                    input >> measurement(row, column);
+                }
+            }
+        }));
+
+        // fill measurement buffer datagram by datagram and stage complete batch for upload
+        std::vector<Eigen::ArrayXXf> buffer(batch, Eigen::ArrayXXf(measurement_rows, measurement_columns));
+        Eigen::ArrayXXf staged(measurement_count, batch);
+        mesh_results.push_back(measure("measurement_batching", mesh, min_time, batch, datagram_bytes, [&]() {
+            for (mpFlow::dtype::index position = 0; position < batch; ++position) {
+                QDataStream input(datagrams[position]);
+                input.setFloatingPointPrecision(QDataStream::SinglePrecision);
+                for (mpFlow::dtype::index row = 0; row < measurement_rows; ++row)
+                for (mpFlow::dtype::index column = 0; column < measurement_columns; ++column) {
+                    input >> buffer[position](row, column);
+                }
+            }
+            for (mpFlow::dtype::index position = 0; position < batch; ++position) {
+                staged.col(position) = Eigen::Map<const Eigen::ArrayXf>(buffer[position].data(),
+                    measurement_count);
+            }
+        }));
+
+        // linearized one step reconstruction with a precomputed reconstruction matrix
+        // followed by the conversion to Siemens of Solver::solve
+        if (sizeof(float) * mesh.elements.rows() * measurement_count <= max_matrix) {
+            Eigen::MatrixXf reconstruction = Eigen::MatrixXf::Random(mesh.elements.rows(),
+                measurement_count) * 1e-2;
+            Eigen::ArrayXXf result(mesh.elements.rows(), batch);
+            mesh_results.push_back(measure("reconstruction", mesh, min_time, batch,
+                sizeof(float) * reconstruction.size(), [&]() {
+                result = sigma_ref * ((reconstruction * staged.matrix()).array() *
+                    std::log(10.0) / 10.0).exp();
+            }));
+        } else {
+            std::fprintf(stderr, "  reconstruction skipped, matrix exceeds --max-matrix\n");
+        }
+
+        // normalization, node averaging and coloring of all frames of batch
+        Eigen::ArrayXXf element_values(frames.rows(), batch);
+        Eigen::ArrayXXf z_values(mesh.nodes.cols(), batch);
+        Eigen::ArrayXXf colors;
+        mesh_results.push_back(measure("render_prepare", mesh, min_time, batch,
+            sizeof(float) * frames.size(), [&]() {
+            RenderPreparer::prepare(frames, mesh.node_averaging, sigma_ref, 0.02,
+                element_values, z_values);
+            for (mpFlow::dtype::index frame = 0; frame < batch; ++frame) {
+                colors = colormap::jet(z_values.col(frame));
+            }
+        }));
+
+        // statistics pipeline and regional means of all frames
+        Eigen::ArrayXf weights = mesh.element_area / mesh.element_area.sum();
+        RegionsOfInterest regions(mesh.nodes, mesh.elements, mesh.element_area);
+        std::vector<FrameStatistics> statistics(batch);
+        Eigen::ArrayXXf region_values;
+        mesh_results.push_back(measure("analysis", mesh, min_time, batch,
+            sizeof(float) * frames.size(), [&]() {
+            for (mpFlow::dtype::index frame = 0; frame < batch; ++frame) {
+                statistics[frame] = StatisticsPipeline::evaluate(frames.col(frame).data(),
+                    weights.data(), weights.size(), sigma_ref);
+            }
+            region_values = regions.apply(frames);
+        }));
+
+        // append batches to recording, with and without compression
+        for (auto compression : { logformat::none, logformat::frame_codec }) {
+            LogWriter writer(4 * 1024 * 1024, compression);
+            if (!writer.open(temporary_dir.filePath(QString("benchmark_%1.log").arg(compression)),
+                frames.rows(), sigma_ref, mesh.nodes, mesh.elements, mesh.electrodes, QByteArray())) {
+                std::fprintf(stderr, "  cannot open log file\n");
+                continue;
+            }
+            Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps(batch);
+            qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+            mesh_results.push_back(measure(compression == logformat::none ? "log_write" :
+                "log_write_compressed", mesh, min_time, batch, sizeof(float) * frames.size(), [&]() {
+                for (mpFlow::dtype::index frame = 0; frame < batch; ++frame) {
+                    timestamps(frame) = timestamp++;
+                }
+                writer.write(timestamps, frames);
+            }));
+            writer.close();
+            QFile::remove(temporary_dir.filePath(QString("benchmark_%1.log").arg(compression)));
+        }
+
+        // encode every frame of batch for mirror stream clients
+        struct Encoding {
+            const char* name;
+            MirrorEncoder::Format format;
+            bool delta;
+        };
+        for (const auto& encoding : { Encoding{ "mirror_encode_f32", MirrorEncoder::float32, false },
+            Encoding{ "mirror_encode_u8_delta", MirrorEncoder::uint8, true } }) {
+            MirrorEncoder encoder(encoding.format, encoding.delta);
+            quint64 frame_id = 0;
+            mesh_results.push_back(measure(encoding.name, mesh, min_time, batch,
+                sizeof(float) * (z_values.rows() + element_values.rows()) * batch, [&]() {
+                for (mpFlow::dtype::index frame = 0; frame < batch; ++frame) {
+                    encoder.encode(++frame_id, mesh.elements, z_values.col(frame),
+                        element_values.col(frame), false);
+                }
+            }));
+        }
+
+        for (const auto& result : mesh_results) {
+            std::fprintf(stderr, "  %-24s %10.3f ms  %12.0f frames/s\n",
+                result.benchmark.toLocal8Bit().constData(), result.times[result.times.size() / 2] * 1e3,
+                result.items / result.times[result.times.size() / 2]);
+            results.append(to_json(result, electrode_count, batch));
+        }
+    }
+
+    QJsonObject json;
+    json["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    json["threads"] = QThread::idealThreadCount();
+    json["results"] = results;
+    QByteArray output = QJsonDocument(json).toJson();
+
+    if (parser.isSet("output")) {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "cannot write %s\n", parser.value("output").toLocal8Bit().constData());
+            return 1;
+        }
+        file.write(output);
+    } else {
+        std::fwrite(output.constData(), 1, output.size(), stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,53 @@
+#-------------------------------------------------
+#
+# Benchmark of all cpu hot paths of the viewer over
+# synthetic circular meshes with json results
+#
+#-------------------------------------------------
+
+QT       += core concurrent
+QT       -= gui
+
+TARGET = pipelinebenchmark
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += pipelinebenchmark.cpp \
+    ../renderpreparer.cpp \
+    ../meshlod.cpp \
+    ../regionsofinterest.cpp \
+    ../logwriter.cpp \
+    ../framecodec.cpp \
+    ../mirrorencoder.cpp \
+    ../latencytracer.cpp \
+    ../profiler.cpp \
+    ../highprecisiontime.cpp
+
+HEADERS += ../renderpreparer.h \
+    ../meshlod.h \
+    ../analysiskernels.h \
+    ../regionsofinterest.h \
+    ../logwriter.h \
+    ../logformat.h \
+    ../framecodec.h \
+    ../mirrorencoder.h \
+    ../mirrorprotocol.h \
+    ../colormap.h \
+    ../latencytracer.h \
+    ../profiler.h \
+    ../highprecisiontime.h
+
+QMAKE_CXXFLAGS += -O3
+
+macx {
+    QMAKE_LIBS += -lc++
+    QMAKE_CXXFLAGS += -mmacosx-version-min=10.7
+}
+
+INCLUDEPATH += /usr/local/cuda/include
+INCLUDEPATH += /usr/local/include
+INCLUDEPATH += /usr/local/include/eigen3
+INCLUDEPATH += /usr/include/eigen3
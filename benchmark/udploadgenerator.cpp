@@ -0,0 +1,242 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QUdpSocket>
+#include <QDataStream>
+#include <QTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+// usage: udploadgenerator [--host 127.0.0.1] [--port 3002] [--rows 16] [--columns 16]
+//     [--rate 1000] [--jitter 0] [--loss 0] [--reorder 0] [--malformed 0]
+//     [--burst 1] [--duration 30] [--viewer-port 3003]
+//
+// sends synthetic measurement datagrams in the layout the measurement system
+// expects, one rows x columns matrix of big endian floats per datagram, at a
+// fixed rate or as fast as possible for rate 0. Send times can be jittered,
+// datagrams dropped, swapped with their successor, truncated or grouped into
+// back to back bursts. Once per second the achieved send rate is printed next
+// to the ingest rate and malformed datagram count reported by the viewer, the
+// rate at which both start to diverge is where the ingest path saturates
+struct Settings {
+    QString host;
+    quint16 port;
+    int rows;
+    int columns;
+    double rate;
+    double jitter;
+    double loss;
+    double reorder;
+    double malformed;
+    int burst;
+};
+
+struct Counters {
+    std::atomic<unsigned long long> sent;
+    std::atomic<unsigned long long> bytes;
+    std::atomic<unsigned long long> lost;
+    std::atomic<unsigned long long> reordered;
+    std::atomic<unsigned long long> malformed;
+    std::atomic<unsigned long long> send_errors;
+    std::atomic<double> max_lag;
+    std::atomic<bool> stop;
+};
+
+// measurement of a slowly breathing homogeneous phantom with a little noise,
+// serialized like the device does
+static QByteArray create_datagram(const Settings& settings, double time,
+    std::mt19937& generator) {
+    std::normal_distribution<float> noise(0.0f, 1e-3f);
+    double breath = 1.0 + 0.05 * std::sin(2.0 * M_PI * 0.25 * time);
+
+    QByteArray datagram;
+    datagram.reserve(settings.rows * settings.columns * sizeof(float));
+    QDataStream output_stream(&datagram, QIODevice::WriteOnly);
+    output_stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    for (int row = 0; row < settings.rows; ++row)
+    for (int column = 0; column < settings.columns; ++column) {
+        // adjacent pattern like decay of voltage with distance between drive and measurement
+        double distance = std::abs(std::sin(M_PI * (row - column) / std::max(settings.rows, 1)));
+        output_stream << (float)((1.0 / (0.1 + distance)) * breath + noise(generator));
+    }
+
+    return datagram;
+}
+
+static void send_datagrams(const Settings& settings, Counters& counters) {
+    typedef std::chrono::steady_clock clock;
+    QUdpSocket socket;
+    QHostAddress address(settings.host);
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> jitter(0.0, settings.jitter * 1e-3);
+
+    auto send = [&](const QByteArray& datagram) {
+        if (socket.writeDatagram(datagram, address, settings.port) < 0) {
+            counters.send_errors += 1;
+            return;
+        }
+        counters.sent += 1;
+        counters.bytes += datagram.size();
+    };
+
+    // bursts keep the average rate, so groups are sent at rate / burst
+    double interval = settings.rate > 0.0 ? settings.burst / settings.rate : 0.0;
+    clock::time_point start = clock::now();
+    QByteArray held_back;
+    for (unsigned long long group = 0; !counters.stop; ++group) {
+        // nominal send time of group with gaussian jitter, never ahead of schedule
+        // by more than one interval
+        if (interval > 0.0) {
+            double offset = group * interval + std::max(-interval,
+                settings.jitter > 0.0 ? jitter(generator) : 0.0);
+            clock::time_point due = start + std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>(offset));
+
+            // sleep most of the wait and spin the rest for accurate timing
+            if (due - clock::now() > std::chrono::microseconds(500)) {
+                std::this_thread::sleep_until(due - std::chrono::microseconds(200));
+            }
+            while (clock::now() < due) {
+            }
+
+            double lag = std::chrono::duration<double>(clock::now() - due).count();
+            if (lag > counters.max_lag) {
+                counters.max_lag = lag;
+            }
+        }
+
+        double time = std::chrono::duration<double>(clock::now() - start).count();
+        for (int datagram_index = 0; datagram_index < settings.burst; ++datagram_index) {
+            QByteArray datagram = create_datagram(settings, time, generator);
+
+            if (uniform(generator) < settings.loss) {
+                counters.lost += 1;
+                continue;
+            }
+            if (uniform(generator) < settings.malformed) {
+                datagram.chop(std::max(1, datagram.size() / 2));
+                counters.malformed += 1;
+            }
+
+            // reordered datagrams are sent after their successor
+            if (held_back.isEmpty() && (uniform(generator) < settings.reorder)) {
+                held_back = datagram;
+                counters.reordered += 1;
+                continue;
+            }
+            send(datagram);
+            if (!held_back.isEmpty()) {
+                send(held_back);
+                held_back.clear();
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("host", "viewer host", "host", "127.0.0.1"));
+    parser.addOption(QCommandLineOption("port", "measurement system port", "port", "3002"));
+    parser.addOption(QCommandLineOption("rows", "measurement rows per datagram", "count", "16"));
+    parser.addOption(QCommandLineOption("columns", "measurement columns per datagram", "count", "16"));
+    parser.addOption(QCommandLineOption("rate", "datagrams per second, 0 for unlimited", "rate", "1000"));
+    parser.addOption(QCommandLineOption("jitter", "standard deviation of send time", "ms", "0"));
+    parser.addOption(QCommandLineOption("loss", "fraction of datagrams not sent", "fraction", "0"));
+    parser.addOption(QCommandLineOption("reorder", "fraction of datagrams swapped with their successor",
+        "fraction", "0"));
+    parser.addOption(QCommandLineOption("malformed", "fraction of truncated datagrams", "fraction", "0"));
+    parser.addOption(QCommandLineOption("burst", "datagrams sent back to back", "count", "1"));
+    parser.addOption(QCommandLineOption("duration", "test duration in seconds", "seconds", "30"));
+    parser.addOption(QCommandLineOption("viewer-port", "mirror server port for ingest statistics",
+        "port", "3003"));
+    parser.process(application);
+
+    Settings settings;
+    settings.host = parser.value("host");
+    settings.port = parser.value("port").toUShort();
+    settings.rows = std::max(1, parser.value("rows").toInt());
+    settings.columns = std::max(1, parser.value("columns").toInt());
+    settings.rate = std::max(0.0, parser.value("rate").toDouble());
+    settings.jitter = std::max(0.0, parser.value("jitter").toDouble());
+    settings.loss = parser.value("loss").toDouble();
+    settings.reorder = parser.value("reorder").toDouble();
+    settings.malformed = parser.value("malformed").toDouble();
+    settings.burst = std::max(1, parser.value("burst").toInt());
+
+    Counters counters;
+    counters.sent = 0;
+    counters.bytes = 0;
+    counters.lost = 0;
+    counters.reordered = 0;
+    counters.malformed = 0;
+    counters.send_errors = 0;
+    counters.max_lag = 0.0;
+    counters.stop = false;
+    std::thread sender(send_datagrams, std::cref(settings), std::ref(counters));
+
+    // ingest statistics of the viewer are taken from its analysis table
+    QNetworkAccessManager network;
+    QString ingest_rate = "n/a", viewer_malformed = "n/a";
+    QString base_url = QString("http://%1:%2").arg(settings.host).arg(parser.value("viewer-port"));
+    auto poll = [&]() {
+        QNetworkReply* reply = network.get(QNetworkRequest(QUrl(base_url + "/analysis-update")));
+        QObject::connect(reply, &QNetworkReply::finished, [&, reply]() {
+            for (const auto& analysis : QJsonDocument::fromJson(reply->readAll())
+                .object()["analysis"].toArray()) {
+                if (analysis.toObject()["name"].toString() == "ingest rate:") {
+                    ingest_rate = analysis.toObject()["result"].toString();
+                } else if (analysis.toObject()["name"].toString() == "malformed datagrams:") {
+                    viewer_malformed = analysis.toObject()["result"].toString();
+                }
+            }
+            reply->deleteLater();
+        });
+    };
+
+    int second = 0;
+    unsigned long long last_sent = 0, last_bytes = 0;
+    QTimer report;
+    QObject::connect(&report, &QTimer::timeout, [&]() {
+        second += 1;
+        unsigned long long sent = counters.sent, bytes = counters.bytes;
+
+        std::printf("time: %d s, sent: %llu 1/s, %.2f MB/s, lost: %llu, reordered: %llu, "
+            "malformed: %llu, send errors: %llu, max lag: %.3f ms, "
+            "viewer ingest rate: %s, viewer malformed: %s\n",
+            second, sent - last_sent, (bytes - last_bytes) * 1e-6, counters.lost.load(),
+            counters.reordered.load(), counters.malformed.load(), counters.send_errors.load(),
+            counters.max_lag.load() * 1e3, ingest_rate.toLocal8Bit().constData(),
+            viewer_malformed.toLocal8Bit().constData());
+        std::fflush(stdout);
+        last_sent = sent;
+        last_bytes = bytes;
+        counters.max_lag = 0.0;
+
+        if (second >= parser.value("duration").toInt()) {
+            application.quit();
+        }
+        poll();
+    });
+    report.start(1000);
+    poll();
+
+    int result = application.exec();
+    counters.stop = true;
+    sender.join();
+
+    return result;
+}
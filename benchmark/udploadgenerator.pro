@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Synthetic measurement system sending datagrams
+# to the viewer at configurable rates
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = udploadgenerator
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += udploadgenerator.cpp
+
+QMAKE_CXXFLAGS += -O3
+
+macx {
+    QMAKE_LIBS += -lc++
+    QMAKE_CXXFLAGS += -mmacosx-version-min=10.7
+}
@@ -0,0 +1,190 @@
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "blockwriter.h"
+#include "profiler.h"
+
+// opens stdio stream on a duplicate of descriptor, which is closed with the stream
+static std::FILE* open_duplicate(int file_descriptor) {
+#ifdef _WIN32
+    int duplicate = _dup(file_descriptor);
+    std::FILE* file = duplicate >= 0 ? _fdopen(duplicate, "r+b") : nullptr;
+    if ((file == nullptr) && (duplicate >= 0)) {
+        _close(duplicate);
+    }
+#else
+    int duplicate = dup(file_descriptor);
+    std::FILE* file = duplicate >= 0 ? fdopen(duplicate, "r+b") : nullptr;
+    if ((file == nullptr) && (duplicate >= 0)) {
+        ::close(duplicate);
+    }
+#endif
+    return file;
+}
+
+// 64 bit seek, logs easily exceed 2 GB
+static bool seek(std::FILE* file, long long offset, int origin) {
+#ifdef _WIN32
+    return _fseeki64(file, offset, origin) == 0;
+#else
+    return fseeko(file, offset, origin) == 0;
+#endif
+}
+
+BlockWriter::BlockWriter(size_t block_size) :
+    block_size_(block_size), active_block_(0), fill_(0), pending_fill_(0), pending_(false),
+    running_(false), file_(nullptr), bytes_written_(0), dropped_records_(0) {
+    // preallocate both blocks, so logging never allocates
+    for (auto& block : this->blocks_) {
+        block.resize(this->block_size());
+    }
+}
+
+BlockWriter::~BlockWriter() {
+    this->close();
+}
+
+bool BlockWriter::open(int file_descriptor) {
+    this->close();
+
+    // own duplicate of descriptor is closed by fclose, original stays open
+    this->file_ = open_duplicate(file_descriptor);
+    if (this->file_ == nullptr) {
+        return false;
+    }
+
+    // start writer thread
+    this->active_block_ = 0;
+    this->fill_ = 0;
+    this->pending_ = false;
+    this->running_ = true;
+    this->thread_ = std::thread(&BlockWriter::run, this);
+
+    return true;
+}
+
+void BlockWriter::close() {
+    if (this->file_ == nullptr) {
+        return;
+    }
+
+    // wait for writer to finish pending block and hand over partially filled one
+    {
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        this->condition_.wait(lock, [=]() { return !this->pending_; });
+        if (this->fill_ > 0) {
+            this->hand_over();
+        }
+        this->running_ = false;
+    }
+    this->condition_.notify_all();
+    this->thread_.join();
+
+    std::fclose(this->file_);
+    this->file_ = nullptr;
+}
+
+void BlockWriter::flush() {
+    if (this->file_ == nullptr) {
+        return;
+    }
+
+    // hand over partially filled block and wait until both blocks are on disk
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->condition_.wait(lock, [=]() { return !this->pending_; });
+    if (this->fill_ > 0) {
+        this->hand_over();
+        this->condition_.wait(lock, [=]() { return !this->pending_; });
+    }
+}
+
+bool BlockWriter::read(long long offset, void* data, size_t size) {
+    if (this->file_ == nullptr) {
+        return false;
+    }
+
+    // file position is shared with writer thread
+    std::lock_guard<std::mutex> lock(this->file_mutex_);
+    return seek(this->file_, offset, SEEK_SET) &&
+        (std::fread(data, 1, size, this->file_) == size);
+}
+
+bool BlockWriter::write(const void* data, size_t size) {
+    return this->write({ std::make_pair(data, size) });
+}
+
+bool BlockWriter::write(const std::vector<std::pair<const void*, size_t>>& parts) {
+    size_t size = 0;
+    for (const auto& part : parts) {
+        size += part.second;
+    }
+
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    if (!this->running_ || (size > this->block_size())) {
+        this->dropped_records() += 1;
+        return false;
+    }
+
+    // records never straddle blocks, hand over block first, if record does not fit
+    if ((this->fill_ + size > this->block_size()) && !this->hand_over()) {
+        this->dropped_records() += 1;
+        return false;
+    }
+
+    for (const auto& part : parts) {
+        std::memcpy(&this->blocks_[this->active_block_][this->fill_], part.first, part.second);
+        this->fill_ += part.second;
+    }
+
+    return true;
+}
+
+bool BlockWriter::hand_over() {
+    // writer is still busy with other block
+    if (this->pending_) {
+        return false;
+    }
+
+    // swap blocks and wake up writer
+    this->pending_fill_ = this->fill_;
+    this->pending_ = true;
+    this->active_block_ = 1 - this->active_block_;
+    this->fill_ = 0;
+    this->condition_.notify_all();
+
+    return true;
+}
+
+void BlockWriter::run() {
+    Profiler::set_thread_name("block writer");
+
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    while (true) {
+        this->condition_.wait(lock, [=]() { return this->pending_ || !this->running_; });
+        if (!this->pending_ && !this->running_) {
+            break;
+        }
+
+        // write pending block without holding lock
+        const char* block = this->blocks_[1 - this->active_block_].data();
+        size_t size = this->pending_fill_;
+        lock.unlock();
+        size_t written = 0;
+        {
+            PROFILE_ZONE("log write block");
+            std::lock_guard<std::mutex> file_lock(this->file_mutex_);
+            if (seek(this->file_, 0, SEEK_END)) {
+                written = std::fwrite(block, 1, size, this->file_);
+            }
+            std::fflush(this->file_);
+        }
+        lock.lock();
+
+        this->bytes_written() += written;
+        this->pending_ = false;
+        this->condition_.notify_all();
+    }
+}
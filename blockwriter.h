@@ -0,0 +1,58 @@
+#ifndef BLOCKWRITER_H
+#define BLOCKWRITER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// writes records to a file through two preallocated blocks and a background
+// thread, producers never wait for the disk, records are dropped instead,
+// if both blocks are in use. Records are always appended to the end of the
+// file, written parts can be read back while writing continues
+class BlockWriter {
+public:
+    explicit BlockWriter(size_t block_size=4 * 1024 * 1024);
+    virtual ~BlockWriter();
+
+    // writer works on a duplicate of the descriptor of an already open read
+    // write file, so the file never has to be opened a second time by name
+    bool open(int file_descriptor);
+    void close();
+    void flush();
+    bool write(const void* data, size_t size);
+    bool write(const std::vector<std::pair<const void*, size_t>>& parts);
+    bool read(long long offset, void* data, size_t size);
+    bool is_open() { return this->file_ != nullptr; }
+
+protected:
+    void run();
+    bool hand_over();
+
+public:
+    // accessors
+    size_t block_size() { return this->block_size_; }
+    std::atomic<unsigned long long>& bytes_written() { return this->bytes_written_; }
+    std::atomic<unsigned long long>& dropped_records() { return this->dropped_records_; }
+
+private:
+    size_t block_size_;
+    std::array<std::vector<char>, 2> blocks_;
+    size_t active_block_;
+    size_t fill_;
+    size_t pending_fill_;
+    bool pending_;
+    bool running_;
+    std::mutex mutex_;
+    std::mutex file_mutex_;
+    std::condition_variable condition_;
+    std::thread thread_;
+    std::FILE* file_;
+    std::atomic<unsigned long long> bytes_written_;
+    std::atomic<unsigned long long> dropped_records_;
+};
+
+#endif // BLOCKWRITER_H
@@ -1,4 +1,5 @@
 #include "calibrator.h"
+#include "profiler.h"
 
 Calibrator::Calibrator(Solver* differential_solver, const QJsonObject& config,
     std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::real>> nodes,
@@ -8,6 +9,8 @@ Calibrator::Calibrator(Solver* differential_solver, const QJsonObject& config,
     : Solver(config, nodes, elements, boundary, 1, cuda_device, parent),
     differential_solver_(differential_solver), filteredData_(nullptr),
     offset_(nullptr), step_size_(2000), filterConstant_(10.0) {
+    this->thread()->setObjectName("calibrator");
+
     connect(this, &Calibrator::initialized, [=](bool success) {
         if (success) {
             // set regularization factor
@@ -33,6 +36,8 @@ void Calibrator::stop() {
 
 void Calibrator::update_data(std::vector<std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::real>>> *data,
     double time_elapsed) {
+    PROFILE_ZONE("calibrate filter");
+
     // create filtered data matrix, if neccessary
     if (this->filteredData() == nullptr) {
         this->filteredData_ = std::make_shared<mpFlow::numeric::Matrix<mpFlow::dtype::real>>(
@@ -66,6 +71,7 @@ void Calibrator::update_data(std::vector<std::shared_ptr<mpFlow::numeric::Matrix
 }
 
 void Calibrator::solve() {
+    PROFILE_ZONE("calibrate");
     this->time().restart();
 
     // copy current data set to solver and add offset
@@ -0,0 +1,29 @@
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include <Eigen/Dense>
+
+namespace colormap {
+    // number of entries of sampled colormap tables
+    const int table_size = 256;
+
+    // map values in range [0.0, 1.0] to jet colors, result contains one rgb triple per row
+    template <
+        class derived
+    >
+    Eigen::ArrayXXf jet(const Eigen::ArrayBase<derived>& values) {
+        Eigen::ArrayXXf colors(values.size(), 3);
+        colors.col(0) = (-4.0 * (values - 0.75).abs() + 1.5).max(0.0).min(1.0);
+        colors.col(1) = (-4.0 * (values - 0.5).abs() + 1.5).max(0.0).min(1.0);
+        colors.col(2) = (-4.0 * (values - 0.25).abs() + 1.5).max(0.0).min(1.0);
+
+        return colors;
+    }
+
+    // sampled jet colormap with interleaved rgb values, suitable for 1D textures
+    inline Eigen::ArrayXXf jet_table() {
+        return jet(Eigen::ArrayXf::LinSpaced(table_size, 0.0, 1.0)).transpose();
+    }
+}
+
+#endif // COLORMAP_H
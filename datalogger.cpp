@@ -1,25 +1,316 @@
 #include "datalogger.h"
+#include "logwriter.h"
+#include "profiler.h"
+#include "highprecisiontime.h"
 #include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+// magic bytes and version identifying binary log files
+static const char log_magic[8] = { 'E', 'I', 'T', 'L', 'O', 'G', 0, 0 };
+static const quint32 log_version = 1;
+
+static const qint64 log_header_size = sizeof(log_magic) + 2 * sizeof(quint32);
+
+// reads header of temporary log file and returns number of values per frame
+static bool read_log_header(BlockWriter& writer, quint32* rows) {
+    char header[log_header_size];
+    quint32 version = 0;
+    if (!writer.read(0, header, sizeof(header))) {
+        return false;
+    }
+    std::memcpy(&version, header + sizeof(log_magic), sizeof(version));
+    std::memcpy(rows, header + sizeof(log_magic) + sizeof(version), sizeof(*rows));
+
+    return (std::memcmp(header, log_magic, sizeof(log_magic)) == 0) &&
+        (version == log_version) && (*rows > 0);
+}
 
 DataLogger::DataLogger(QObject *parent) :
-    QObject(parent) {
+    QObject(parent), logging_(false), log_measurements_(false),
+    image_log_(new Stream()), measurement_log_(new Stream()), region_log_(new Stream()) {
+    // create temporary log files, writers stay attached to them for the
+    // lifetime of the logger and only accept records while logging
+    for (auto stream : { &this->image_log(), &this->measurement_log(), &this->region_log() }) {
+        if (stream->file.open()) {
+            stream->writer.open(stream->file.handle());
+        }
+    }
+}
+
+DataLogger::~DataLogger() {
+    this->stop_logging();
+}
+
+void DataLogger::start_logging() {
+    for (auto stream : { &this->image_log(), &this->measurement_log(), &this->region_log() }) {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->active = (stream != &this->measurement_log()) || this->log_measurements();
+    }
+    this->logging() = true;
+}
+
+void DataLogger::stop_logging() {
+    this->logging() = false;
+
+    for (auto stream : { &this->image_log(), &this->measurement_log(), &this->region_log() }) {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->active = false;
+        stream->writer.flush();
+    }
+}
+
+void DataLogger::reset_log() {
+    for (auto stream : { &this->image_log(), &this->measurement_log(), &this->region_log() }) {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+
+        // discard all logged frames, writer always appends to end of file
+        stream->writer.flush();
+        stream->file.resize(0);
+        stream->rows = 0;
+        stream->frame_count = 0;
+    }
 }
 
-void DataLogger::add_data(Eigen::ArrayXXf data) {
-    if (this->logging()) {
-        // add current data set to buffer
-        this->data().push_back(std::make_tuple(
-            QDateTime::currentMSecsSinceEpoch(), data));
+void DataLogger::set_log_measurements(bool log_measurements) {
+    this->log_measurements() = log_measurements;
+
+    // start or stop raw measurement log immediately, if logger is running
+    std::lock_guard<std::mutex> lock(this->measurement_log().mutex);
+    this->measurement_log().active = log_measurements && this->logging();
+    if (!log_measurements) {
+        this->measurement_log().writer.flush();
+    }
+}
+
+void DataLogger::add_data(Eigen::ArrayXXf data, double time_elapsed, double timestamp) {
+    PROFILE_ZONE("log data");
+    if (!this->logging()) {
+        return;
+    }
+
+    // frames of batch were acquired evenly spaced over elapsed time, last one
+    // at acquisition time stamp of batch, not when reconstruction finished
+    this->add_records(this->image_log(), data.data(), data.rows(), data.cols(),
+        timestamp > 0.0 ? HighPrecisionTime::wall_clock(timestamp) :
+        QDateTime::currentMSecsSinceEpoch(), time_elapsed);
+}
+
+void DataLogger::add_measurement(QByteArray datagram, mpFlow::dtype::index rows,
+    mpFlow::dtype::index columns) {
+    PROFILE_ZONE("log measurement");
+    if (!this->logging() || !this->log_measurements() ||
+        ((size_t)datagram.size() < sizeof(float) * rows * columns)) {
+        return;
     }
+    qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    // convert big endian values of datagram in received order, buffer
+    // is only used by measurement system thread
+    this->measurement_buffer().resize(rows * columns);
+    const uchar* values = reinterpret_cast<const uchar*>(datagram.constData());
+    for (mpFlow::dtype::index i = 0; i < rows * columns; ++i) {
+        quint32 value = qFromBigEndian<quint32>(values + sizeof(float) * i);
+        std::memcpy(&this->measurement_buffer()[i], &value, sizeof(float));
+    }
+
+    this->add_records(this->measurement_log(), this->measurement_buffer().data(),
+        rows * columns, 1, timestamp, 0.0, columns);
 }
 
-void DataLogger::dump(std::ostream *ostream) {
-    if (ostream == nullptr) {
+void DataLogger::add_regions(std::shared_ptr<const RegionSamples> samples) {
+    PROFILE_ZONE("log regions");
+    if (!this->logging()) {
         return;
     }
 
-    for (const auto& d : this->data())
-    for (mpFlow::dtype::index i = 0; i < std::get<1>(d).cols(); ++i) {
-        (*ostream) << std::get<0>(d) << " " << std::get<1>(d).col(i).transpose() << std::endl;
+    // region names are stored with saved log, they only change with mesh
+    if (this->region_names() != samples->regions->names()) {
+        std::lock_guard<std::mutex> lock(this->region_log().mutex);
+        this->region_names() = samples->regions->names();
+    }
+
+    // regional samples carry their own time stamps
+    for (mpFlow::dtype::index column = 0; column < samples->values.cols(); ++column) {
+        this->add_records(this->region_log(), samples->values.col(column).data(),
+            samples->values.rows(), 1, samples->timestamps(column), 0.0);
+    }
+}
+
+bool DataLogger::add_records(Stream& stream, const float* data, mpFlow::dtype::index rows,
+    mpFlow::dtype::index count, qint64 timestamp, double time_elapsed,
+    mpFlow::dtype::index columns) {
+    // never wait for reconfiguration of logger, frames are dropped instead
+    std::unique_lock<std::mutex> lock(stream.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || !stream.active) {
+        return false;
+    }
+
+    // write file header with frame layout on first frame, layout is fixed until log is reset,
+    // a dropped header is retried with the next frames instead of logging without it
+    if (stream.rows == 0) {
+        quint32 header_rows = rows;
+        if (!stream.writer.write({ std::make_pair((const void*)log_magic, sizeof(log_magic)),
+            std::make_pair((const void*)&log_version, sizeof(log_version)),
+            std::make_pair((const void*)&header_rows, sizeof(header_rows)) })) {
+            return false;
+        }
+        stream.rows = rows;
+        stream.columns = columns;
+    } else if ((stream.rows != rows) || (stream.columns != columns)) {
+        return false;
     }
+
+    // add one fixed size record per frame, last frame is stamped with given time stamp
+    for (mpFlow::dtype::index frame = 0; frame < count; ++frame) {
+        qint64 frame_timestamp = timestamp -
+            (qint64)((count - 1 - frame) * time_elapsed * 1e3 / count);
+        if (stream.writer.write({ std::make_pair((const void*)&frame_timestamp, sizeof(frame_timestamp)),
+            std::make_pair((const void*)(data + frame * rows), sizeof(float) * rows) })) {
+            stream.frame_count += 1;
+        }
+    }
+
+    return true;
+}
+
+qint64 DataLogger::flush(Stream& stream) {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+
+    // all flushed records can be read back while logging continues
+    stream.writer.flush();
+    return stream.rows > 0 ? stream.frame_count : 0;
+}
+
+bool DataLogger::save(const QString& file_name, mpFlow::dtype::real sigma_ref,
+    const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::ArrayXXf& electrodes, const QByteArray& config) {
+    bool success = this->save_frames(file_name, sigma_ref, nodes, elements, electrodes, config);
+
+    // raw measurements are saved next to image log with same config, so they
+    // can be reconstructed offline again, values of each measurement are
+    // stored in received row major order
+    qint64 measurement_count = this->flush(this->measurement_log());
+    if (success && (measurement_count > 0)) {
+        QJsonObject measurement_config = QJsonDocument::fromJson(config).object();
+        QJsonObject layout;
+        {
+            std::lock_guard<std::mutex> lock(this->measurement_log().mutex);
+            layout["rows"] = (int)(this->measurement_log().rows / std::max(this->measurement_log().columns,
+                (mpFlow::dtype::index)1));
+            layout["columns"] = (int)this->measurement_log().columns;
+        }
+        layout["order"] = QString("row major");
+        measurement_config["measurement_layout"] = layout;
+
+        success &= this->convert(this->measurement_log(), measurement_count, file_name + ".raw",
+            sigma_ref, Eigen::ArrayXXf(2, 0),
+            Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>(0, 3),
+            Eigen::ArrayXXf(4, 0), QJsonDocument(measurement_config).toJson(QJsonDocument::Compact));
+    }
+
+    // regional mean values are saved the same way with names of regions
+    qint64 region_count = this->flush(this->region_log());
+    if (success && (region_count > 0)) {
+        QJsonObject region_config = QJsonDocument::fromJson(config).object();
+        {
+            std::lock_guard<std::mutex> lock(this->region_log().mutex);
+            region_config["regions"] = QJsonArray::fromStringList(this->region_names());
+        }
+
+        success &= this->convert(this->region_log(), region_count, file_name + ".regions",
+            sigma_ref, Eigen::ArrayXXf(2, 0),
+            Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>(0, 3),
+            Eigen::ArrayXXf(4, 0), QJsonDocument(region_config).toJson(QJsonDocument::Compact));
+    }
+
+    return success;
+}
+
+bool DataLogger::save_frames(const QString& file_name, mpFlow::dtype::real sigma_ref,
+    const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::ArrayXXf& electrodes, const QByteArray& config) {
+    // only image log, so it can be read back as recording
+    return this->convert(this->image_log(), this->flush(this->image_log()), file_name,
+        sigma_ref, nodes, elements, electrodes, config);
+}
+
+bool DataLogger::convert(Stream& stream, qint64 frame_count, const QString& file_name,
+    mpFlow::dtype::real sigma_ref, const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::ArrayXXf& electrodes, const QByteArray& config) {
+    quint32 rows = 0;
+    if (!read_log_header(stream.writer, &rows)) {
+        return false;
+    }
+
+    // convert records block wise to recording file
+    LogWriter log_writer(4 * 1024 * 1024, logformat::frame_codec);
+    if (!log_writer.open(file_name, rows, sigma_ref, nodes, elements, electrodes, config)) {
+        return false;
+    }
+    Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps(log_writer.header().frames_per_block);
+    Eigen::ArrayXXf frames(rows, log_writer.header().frames_per_block);
+    bool success = true;
+    for (qint64 frame = 0; frame < frame_count; frame += frames.cols()) {
+        mpFlow::dtype::index count = std::min((qint64)frames.cols(), frame_count - frame);
+        success &= this->read_records(stream, frame, frames.leftCols(count), timestamps.data());
+        success &= log_writer.write(timestamps.head(count), frames.leftCols(count));
+    }
+    success &= log_writer.close();
+
+    return success;
+}
+
+bool DataLogger::read_records(Stream& stream, qint64 first, Eigen::Ref<Eigen::ArrayXXf> frames,
+    qint64* timestamps) {
+    // records are read with a single read and split afterwards
+    qint64 record_size = sizeof(qint64) + sizeof(float) * frames.rows();
+    std::vector<char> records(record_size * frames.cols());
+    if (!stream.writer.read(log_header_size + first * record_size, records.data(), records.size())) {
+        return false;
+    }
+
+    for (mpFlow::dtype::index frame = 0; frame < frames.cols(); ++frame) {
+        const char* record = records.data() + frame * record_size;
+        std::memcpy(&timestamps[frame], record, sizeof(qint64));
+        std::memcpy(frames.col(frame).data(), record + sizeof(qint64), sizeof(float) * frames.rows());
+    }
+
+    return true;
+}
+
+qint64 DataLogger::frame_count() {
+    return this->flush(this->image_log());
+}
+
+Eigen::ArrayXXf DataLogger::frames(qint64 first, qint64 count, std::vector<qint64>* timestamps) {
+    // only the requested range of flushed records is held in memory
+    quint32 rows = 0;
+    qint64 frame_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(this->image_log().mutex);
+        frame_count = this->image_log().rows > 0 ? this->image_log().frame_count : 0;
+    }
+    count = std::max((qint64)0, std::min(count, frame_count - first));
+    if ((count == 0) || !read_log_header(this->image_log().writer, &rows)) {
+        return Eigen::ArrayXXf();
+    }
+
+    Eigen::ArrayXXf frames(rows, count);
+    std::vector<qint64> frame_timestamps(count);
+    if (!this->read_records(this->image_log(), first, frames, frame_timestamps.data())) {
+        return Eigen::ArrayXXf();
+    }
+    if (timestamps != nullptr) {
+        *timestamps = frame_timestamps;
+    }
+
+    return frames;
 }
@@ -2,35 +2,92 @@
 #define DATALOGGER_H
 
 #include <QObject>
-#include <vector>
-#include <tuple>
-#include <iostream>
+#include <QTemporaryFile>
+#include <QByteArray>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <mpflow/mpflow.h>
+#include "blockwriter.h"
+#include "regionsofinterest.h"
 
+// streams reconstructed frames, regional mean values and optionally raw measurements as fixed
+// layout binary records to temporary log files, memory use is constant
+// regardless of session length, saved logs are converted to indexed
+// recording files
 class DataLogger : public QObject {
     Q_OBJECT
 public:
+    // one temporary log file with its background writer, producers only
+    // try to lock the stream and drop records instead of waiting, the writer
+    // works on the open file and is destroyed before it
+    struct Stream {
+        std::mutex mutex;
+        QTemporaryFile file;
+        BlockWriter writer;
+        bool active = false;
+        mpFlow::dtype::index rows = 0;
+        mpFlow::dtype::index columns = 1;
+        qint64 frame_count = 0;
+    };
+
     explicit DataLogger(QObject *parent = 0);
-    
+    virtual ~DataLogger();
+
 signals:
-    
+
 public slots:
-    void start_logging() { this->logging() = true; }
-    void stop_logging() { this->logging() = false; }
-    void reset_log() { this->data().clear(); }
-    void add_data(Eigen::ArrayXXf data);
+    void start_logging();
+    void stop_logging();
+    void reset_log();
+    void set_log_measurements(bool log_measurements);
+    void add_data(Eigen::ArrayXXf data, double time_elapsed=0.0, double timestamp=0.0);
+    void add_measurement(QByteArray datagram, mpFlow::dtype::index rows,
+        mpFlow::dtype::index columns);
+    void add_regions(std::shared_ptr<const RegionSamples> samples);
 
 public:
-    void dump(std::ostream* ostream);
+    bool save(const QString& file_name, mpFlow::dtype::real sigma_ref,
+        const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::ArrayXXf& electrodes, const QByteArray& config);
+    bool save_frames(const QString& file_name, mpFlow::dtype::real sigma_ref,
+        const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::ArrayXXf& electrodes, const QByteArray& config);
+    qint64 frame_count();
+    Eigen::ArrayXXf frames(qint64 first, qint64 count, std::vector<qint64>* timestamps=nullptr);
+
+protected:
+    bool read_records(Stream& stream, qint64 first, Eigen::Ref<Eigen::ArrayXXf> frames,
+        qint64* timestamps);
+    bool add_records(Stream& stream, const float* data, mpFlow::dtype::index rows,
+        mpFlow::dtype::index count, qint64 timestamp, double time_elapsed,
+        mpFlow::dtype::index columns=1);
+    qint64 flush(Stream& stream);
+    bool convert(Stream& stream, qint64 frame_count, const QString& file_name,
+        mpFlow::dtype::real sigma_ref, const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::ArrayXXf& electrodes, const QByteArray& config);
 
 public:
     // Accessors
-    bool& logging() { return this->logging_; }
-    std::vector<std::tuple<qint64, Eigen::ArrayXXf>>& data() { return this->data_; }
+    std::atomic<bool>& logging() { return this->logging_; }
+    std::atomic<bool>& log_measurements() { return this->log_measurements_; }
+    Stream& image_log() { return *this->image_log_; }
+    Stream& measurement_log() { return *this->measurement_log_; }
+    Stream& region_log() { return *this->region_log_; }
+    QStringList& region_names() { return this->region_names_; }
+    std::vector<float>& measurement_buffer() { return this->measurement_buffer_; }
 
 private:
-    bool logging_;
-    std::vector<std::tuple<qint64, Eigen::ArrayXXf>> data_;
+    std::atomic<bool> logging_;
+    std::atomic<bool> log_measurements_;
+    std::unique_ptr<Stream> image_log_;
+    std::unique_ptr<Stream> measurement_log_;
+    std::unique_ptr<Stream> region_log_;
+    QStringList region_names_;
+    std::vector<float> measurement_buffer_;
 };
 
 #endif // DATALOGGER_H
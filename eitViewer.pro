@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core widgets opengl network
+QT       += core widgets opengl network concurrent
 LIBS += -lqhttpserver
 
 # get version number
@@ -19,21 +19,66 @@ SOURCES += main.cpp\
     image.cpp \
     measurementsystem.cpp \
     solver.cpp \
+    meshgenerator.cpp \
     calibrator.cpp \
     calibratordialog.cpp \
     datalogger.cpp \
     highprecisiontime.cpp \
-    mirrorserver.cpp
+    mirrorserver.cpp \
+    mirrorencoder.cpp \
+    analysisengine.cpp \
+    regionsofinterest.cpp \
+    regionplot.cpp \
+    framehistory.cpp \
+    latencytracer.cpp \
+    latencyview.cpp \
+    profiler.cpp \
+    renderpreparer.cpp \
+    offscreenrenderer.cpp \
+    frameexporter.cpp \
+    framescheduler.cpp \
+    meshlod.cpp \
+    blockwriter.cpp \
+    logwriter.cpp \
+    logreader.cpp \
+    logplayer.cpp \
+    framecodec.cpp \
+    textexporter.cpp
 
 HEADERS  += mainwindow.h \
     image.h \
     measurementsystem.h \
     solver.h \
+    meshgenerator.h \
     calibrator.h \
     calibratordialog.h \
     datalogger.h \
     highprecisiontime.h \
-    mirrorserver.h
+    mirrorserver.h \
+    mirrorprotocol.h \
+    mirrorsnapshot.h \
+    mirrorencoder.h \
+    analysisengine.h \
+    analysiskernels.h \
+    regionsofinterest.h \
+    regionplot.h \
+    framehistory.h \
+    latencytracer.h \
+    latencyview.h \
+    profiler.h \
+    colormap.h \
+    renderpreparer.h \
+    offscreenrenderer.h \
+    frameexporter.h \
+    framescheduler.h \
+    meshlod.h \
+    blockwriter.h \
+    logformat.h \
+    logwriter.h \
+    logreader.h \
+    logplayer.h \
+    framecodec.h \
+    textexporter.h
 
 FORMS    += mainwindow.ui \
     calibratordialog.ui
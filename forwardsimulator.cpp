@@ -0,0 +1,254 @@
+#include <QJsonArray>
+#include <QtConcurrent>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include "forwardsimulator.h"
+
+static Eigen::MatrixXd matrixFromJsonArray(const QJsonArray& array, const char* name) {
+    // patterns have to be non empty arrays of equally sized rows
+    if (array.isEmpty() || !array.first().isArray() || array.first().toArray().isEmpty()) {
+        throw std::invalid_argument(std::string("ForwardSimulator: missing ") + name);
+    }
+
+    Eigen::MatrixXd matrix(array.size(), array.first().toArray().size());
+    for (mpFlow::dtype::index row = 0; row < matrix.rows(); ++row) {
+        if (array[row].toArray().size() != matrix.cols()) {
+            throw std::invalid_argument(std::string("ForwardSimulator: ragged ") + name);
+        }
+        for (mpFlow::dtype::index column = 0; column < matrix.cols(); ++column) {
+            matrix(row, column) = array[row].toArray()[column].toDouble();
+        }
+    }
+
+    return matrix;
+}
+
+ForwardSimulator::ForwardSimulator(const QJsonObject& config, const Nodes& nodes,
+    const Elements& elements, const Elements& boundary, const Eigen::Ref<const Eigen::ArrayXXd>& electrodes,
+    double contact_impedance, double tolerance, int max_iterations, double refactorization_iterations) :
+    nodes_(nodes), elements_(elements), tolerance_(tolerance), max_iterations_(max_iterations),
+    refactorization_iterations_(refactorization_iterations), factorizations_(0), iterations_(0) {
+    // load model parameter from config
+    auto model = config["model"].toObject();
+    this->radius() = model["mesh"].toObject()["radius"].toDouble();
+    this->height() = model["mesh"].toObject()["height"].toDouble();
+    this->sigma_ref() = model["sigma_ref"].toDouble();
+    this->drive_pattern_ = matrixFromJsonArray(model["source"].toObject()["drive_pattern"].toArray(),
+        "drive_pattern");
+    this->measurement_pattern_ = matrixFromJsonArray(
+        model["source"].toObject()["measurement_pattern"].toArray(), "measurement_pattern");
+    if ((this->radius() <= 0.0) || (this->height() <= 0.0)) {
+        throw std::invalid_argument("ForwardSimulator: invalid mesh radius or height");
+    }
+    if ((this->measurement_pattern_.rows() != this->drive_pattern_.rows()) ||
+        (electrodes.rows() != 2 * 2) || (electrodes.cols() != this->drive_pattern_.rows())) {
+        throw std::invalid_argument("ForwardSimulator: patterns do not match electrode count");
+    }
+    if (model["source"].toObject()["current"].isArray() &&
+        (model["source"].toObject()["current"].toArray().size() < (int)this->drive_count())) {
+        throw std::invalid_argument("ForwardSimulator: current does not match drive count");
+    }
+    this->current_ = Eigen::VectorXd::Constant(this->drive_count(),
+        model["source"].toObject()["current"].toDouble());
+    if (model["source"].toObject()["current"].isArray()) {
+        for (mpFlow::dtype::index i = 0; i < this->drive_count(); ++i) {
+            this->current_(i) = model["source"].toObject()["current"].toArray()[i].toDouble();
+        }
+    }
+
+    // unknowns are node potentials followed by electrode potentials,
+    // node 0 is grounded to make the system positive definite
+    mpFlow::dtype::index node_count = nodes.rows();
+    mpFlow::dtype::index size = node_count + this->electrode_count();
+    std::vector<Eigen::Triplet<double>> triplets;
+    auto add = [&](mpFlow::dtype::index row, mpFlow::dtype::index column, double value) {
+        if ((row != 0) && (column != 0)) {
+            triplets.push_back(Eigen::Triplet<double>(row, column, value));
+        }
+    };
+    triplets.push_back(Eigen::Triplet<double>(0, 0, 1.0));
+
+    // stiffness of each element for unit conductivity, scaled by mesh height
+    this->element_centers_.resize(elements.rows(), 2);
+    this->element_area_.resize(elements.rows());
+    this->element_stiffness_.resize(elements.rows(), 9);
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element) {
+        Eigen::Matrix<double, 3, 2> points;
+        for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+            points.row(node) << nodes(elements(element, node), 0), nodes(elements(element, node), 1);
+        }
+        this->element_centers_.row(element) = points.colwise().mean().array();
+
+        // gradients of linear basis functions
+        Eigen::Matrix<double, 3, 2> gradients;
+        for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+            const auto& next = points.row((node + 1) % 3);
+            const auto& last = points.row((node + 2) % 3);
+            gradients.row(node) << next(1) - last(1), last(0) - next(0);
+        }
+        double area = 0.5 * std::abs((points(1, 0) - points(0, 0)) * (points(2, 1) - points(0, 1)) -
+            (points(2, 0) - points(0, 0)) * (points(1, 1) - points(0, 1)));
+        this->element_area_(element) = area;
+
+        Eigen::Matrix3d stiffness = this->height() * gradients * gradients.transpose() / (4.0 * area);
+        for (mpFlow::dtype::index i = 0; i < 3; ++i)
+        for (mpFlow::dtype::index j = 0; j < 3; ++j) {
+            this->element_stiffness_(element, i * 3 + j) = stiffness(i, j);
+            add(elements(element, i), elements(element, j), 0.0);
+        }
+    }
+
+    // angular center and half span of each electrode from its end points
+    Eigen::ArrayXd electrode_centers(this->electrode_count());
+    Eigen::ArrayXd electrode_half_spans(this->electrode_count());
+    for (mpFlow::dtype::index electrode = 0; electrode < this->electrode_count(); ++electrode) {
+        double begin = std::atan2(electrodes(1, electrode), electrodes(0, electrode));
+        double end = std::atan2(electrodes(3, electrode), electrodes(2, electrode));
+        double span = end - begin < 0.0 ? end - begin + 2.0 * M_PI : end - begin;
+        electrode_centers(electrode) = begin + 0.5 * span;
+        electrode_half_spans(electrode) = 0.5 * span;
+    }
+
+    // boundary integrals of complete electrode model over the part of each
+    // boundary edge covered by an electrode, edges are parametrized linear in angle,
+    // electrodes contact the boundary over their height, at most the mesh height
+    double conductance = std::min(this->height(),
+        model["electrodes"].toObject()["height"].toDouble()) / contact_impedance;
+    for (mpFlow::dtype::index edge = 0; edge < boundary.rows(); ++edge) {
+        mpFlow::dtype::index a = boundary(edge, 0), b = boundary(edge, 1);
+        double angle_a = std::atan2(nodes(a, 1), nodes(a, 0));
+        double angle_b = std::atan2(nodes(b, 1), nodes(b, 0));
+        double span = std::remainder(angle_b - angle_a, 2.0 * M_PI);
+        double length = std::hypot(nodes(b, 0) - nodes(a, 0), nodes(b, 1) - nodes(a, 1));
+        double edge_begin = std::min(angle_a, angle_a + span), edge_end = std::max(angle_a, angle_a + span);
+
+        for (mpFlow::dtype::index electrode = 0; electrode < this->electrode_count(); ++electrode) {
+            double center = angle_a + std::remainder(
+                electrode_centers(electrode) - angle_a, 2.0 * M_PI);
+            double begin = std::max(edge_begin, center - electrode_half_spans(electrode));
+            double end = std::min(edge_end, center + electrode_half_spans(electrode));
+            if ((end <= begin) || (span == 0.0)) {
+                continue;
+            }
+
+            // covered interval in edge parameter s, basis functions are 1 - s and s
+            double s0 = (begin - angle_a) / span, s1 = (end - angle_a) / span;
+            if (s0 > s1) {
+                std::swap(s0, s1);
+            }
+            double scale = conductance * length;
+            double aa = scale * (std::pow(1.0 - s0, 3) - std::pow(1.0 - s1, 3)) / 3.0;
+            double bb = scale * (std::pow(s1, 3) - std::pow(s0, 3)) / 3.0;
+            double ab = scale * ((s1 * s1 - s0 * s0) / 2.0 - (std::pow(s1, 3) - std::pow(s0, 3)) / 3.0);
+            double ae = scale * ((s1 - s0) - (s1 * s1 - s0 * s0) / 2.0);
+            double be = scale * (s1 * s1 - s0 * s0) / 2.0;
+            mpFlow::dtype::index e = node_count + electrode;
+
+            add(a, a, aa);
+            add(b, b, bb);
+            add(a, b, ab);
+            add(b, a, ab);
+            add(a, e, -ae);
+            add(e, a, -ae);
+            add(b, e, -be);
+            add(e, b, -be);
+            add(e, e, scale * (s1 - s0));
+        }
+    }
+
+    // fixed sparse pattern, boundary values are the conductivity independent part
+    this->system_matrix_.resize(size, size);
+    this->system_matrix_.setFromTriplets(triplets.begin(), triplets.end());
+    this->system_matrix_.makeCompressed();
+    this->boundary_values_ = Eigen::Map<Eigen::VectorXd>(this->system_matrix_.valuePtr(),
+        this->system_matrix_.nonZeros());
+
+    // position of each element stiffness entry in value array
+    auto position = [&](mpFlow::dtype::index row, mpFlow::dtype::index column) -> Eigen::Index {
+        if ((row == 0) || (column == 0)) {
+            return -1;
+        }
+        return &this->system_matrix_.coeffRef(row, column) - this->system_matrix_.valuePtr();
+    };
+    this->element_entries_.resize(elements.rows(), 9);
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element)
+    for (mpFlow::dtype::index i = 0; i < 3; ++i)
+    for (mpFlow::dtype::index j = 0; j < 3; ++j) {
+        this->element_entries_(element, i * 3 + j) = position(elements(element, i), elements(element, j));
+    }
+    this->preconditioner_.analyzePattern(Eigen::SparseMatrix<double>(this->system_matrix_));
+
+    // excitation of each drive pattern
+    this->rhs_ = Eigen::MatrixXd::Zero(size, this->drive_count());
+    this->rhs_.bottomRows(this->electrode_count()) = this->drive_pattern_ * this->current_.asDiagonal();
+    this->potentials_ = Eigen::MatrixXd::Zero(size, this->drive_count());
+    for (mpFlow::dtype::index pattern = 0; pattern < this->drive_count(); ++pattern) {
+        this->patterns_.push_back(pattern);
+    }
+}
+
+Eigen::ArrayXXf ForwardSimulator::solve(const Eigen::Ref<const Eigen::ArrayXd>& sigma) {
+    this->assemble(sigma);
+
+    // drive patterns are independent systems with the same matrix
+    this->iterations_ = 0;
+    QtConcurrent::blockingMap(this->patterns_, [&](const mpFlow::dtype::index& pattern) {
+        this->iterations_ += this->solve_pattern(pattern);
+    });
+
+    return (this->measurement_pattern_.transpose() *
+        this->potentials_.bottomRows(this->electrode_count())).cast<float>().array();
+}
+
+void ForwardSimulator::assemble(const Eigen::Ref<const Eigen::ArrayXd>& sigma) {
+    Eigen::Map<Eigen::VectorXd> values(this->system_matrix_.valuePtr(),
+        this->system_matrix_.nonZeros());
+    values = this->boundary_values_;
+    for (mpFlow::dtype::index element = 0; element < this->element_entries_.rows(); ++element)
+    for (mpFlow::dtype::index entry = 0; entry < 9; ++entry) {
+        if (this->element_entries_(element, entry) >= 0) {
+            values(this->element_entries_(element, entry)) +=
+                sigma(element) * this->element_stiffness_(element, entry);
+        }
+    }
+
+    // cholesky factor of an earlier system is the preconditioner, it is only
+    // renewed once conductivity drifted too far for cg to converge quickly,
+    // symmetric row major matrix is its own column major transpose
+    if ((this->factorizations() == 0) || (this->iterations() > this->refactorization_iterations_)) {
+        this->preconditioner_.factorize(Eigen::Map<const Eigen::SparseMatrix<double>>(
+            this->system_matrix_.rows(), this->system_matrix_.cols(), this->system_matrix_.nonZeros(),
+            this->system_matrix_.outerIndexPtr(), this->system_matrix_.innerIndexPtr(),
+            this->system_matrix_.valuePtr()));
+        this->factorizations() += 1;
+    }
+}
+
+int ForwardSimulator::solve_pattern(mpFlow::dtype::index pattern) {
+    // preconditioned cg starting at potentials of previous solve
+    auto x = this->potentials_.col(pattern);
+    auto b = this->rhs_.col(pattern);
+    double threshold = this->tolerance_ * b.norm();
+
+    Eigen::VectorXd residual = b - this->system_matrix_ * x;
+    Eigen::VectorXd z = this->preconditioner_.solve(residual);
+    Eigen::VectorXd direction = z;
+    Eigen::VectorXd projection(x.rows());
+    double rz = residual.dot(z);
+
+    int iteration = 0;
+    for (; (iteration < this->max_iterations_) && (residual.norm() > threshold); ++iteration) {
+        projection.noalias() = this->system_matrix_ * direction;
+        double alpha = rz / direction.dot(projection);
+        x += alpha * direction;
+        residual -= alpha * projection;
+
+        z = this->preconditioner_.solve(residual);
+        double rz_new = residual.dot(z);
+        direction = z + (rz_new / rz) * direction;
+        rz = rz_new;
+    }
+
+    return iteration;
+}
@@ -0,0 +1,86 @@
+#ifndef FORWARDSIMULATOR_H
+#define FORWARDSIMULATOR_H
+
+#include <QJsonObject>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <mpflow/mpflow.h>
+#include "meshgenerator.h"
+
+// cpu finite element forward solver of the complete electrode model with
+// linear basis functions, creating measurements of arbitrary conductivity
+// distributions for the mesh, electrodes and patterns of a solver config.
+// The system matrix is assembled once into a fixed sparse pattern, for each
+// new conductivity distribution only its values are scattered again and all
+// drive patterns are solved in parallel by cg, warm started with the potentials
+// of the previous frame and preconditioned by the cholesky factor of an earlier
+// frame, so slowly changing phantoms converge within a few iterations
+class ForwardSimulator {
+public:
+    typedef meshgenerator::Nodes Nodes;
+    typedef meshgenerator::Elements Elements;
+
+    // throws std::invalid_argument for configs without matching patterns and electrodes,
+    // electrodes hold start and end point of each electrode as column, like
+    // mpFlow electrode coordinates, each covering the boundary counterclockwise
+    // from start to end over its height, contact impedance matches createSolverFromConfig
+    ForwardSimulator(const QJsonObject& config, const Nodes& nodes, const Elements& elements,
+        const Elements& boundary, const Eigen::Ref<const Eigen::ArrayXXd>& electrodes,
+        double contact_impedance=1.0, double tolerance=1e-6, int max_iterations=2000,
+        double refactorization_iterations=16.0);
+
+    // measurement (rows) of each drive pattern (columns) for the conductivity of each element
+    Eigen::ArrayXXf solve(const Eigen::Ref<const Eigen::ArrayXd>& sigma);
+
+protected:
+    void assemble(const Eigen::Ref<const Eigen::ArrayXd>& sigma);
+    int solve_pattern(mpFlow::dtype::index pattern);
+
+public:
+    // accessors
+    Nodes& nodes() { return this->nodes_; }
+    Elements& elements() { return this->elements_; }
+    Eigen::ArrayXXd& element_centers() { return this->element_centers_; }
+    Eigen::ArrayXd& element_area() { return this->element_area_; }
+    double& radius() { return this->radius_; }
+    double& height() { return this->height_; }
+    double& sigma_ref() { return this->sigma_ref_; }
+    mpFlow::dtype::index electrode_count() { return this->drive_pattern_.rows(); }
+    mpFlow::dtype::index drive_count() { return this->drive_pattern_.cols(); }
+    mpFlow::dtype::index measurement_count() { return this->measurement_pattern_.cols(); }
+    Eigen::SparseMatrix<double, Eigen::RowMajor>& system_matrix() { return this->system_matrix_; }
+    long& factorizations() { return this->factorizations_; }
+    // mean cg iterations per drive pattern of last solve
+    double iterations() { return (double)this->iterations_ / std::max((mpFlow::dtype::index)1, this->drive_count()); }
+
+private:
+    Nodes nodes_;
+    Elements elements_;
+    Eigen::ArrayXXd element_centers_;
+    Eigen::ArrayXd element_area_;
+    double radius_;
+    double height_;
+    double sigma_ref_;
+    double tolerance_;
+    int max_iterations_;
+    double refactorization_iterations_;
+    long factorizations_;
+    Eigen::MatrixXd drive_pattern_;
+    Eigen::MatrixXd measurement_pattern_;
+    Eigen::VectorXd current_;
+    Eigen::SparseMatrix<double, Eigen::RowMajor> system_matrix_;
+    Eigen::VectorXd boundary_values_;
+    Eigen::ArrayXXd element_stiffness_;
+    Eigen::Array<Eigen::Index, Eigen::Dynamic, Eigen::Dynamic> element_entries_;
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<double>, Eigen::Lower, Eigen::AMDOrdering<int>> preconditioner_;
+    Eigen::MatrixXd rhs_;
+    Eigen::MatrixXd potentials_;
+    std::vector<mpFlow::dtype::index> patterns_;
+    std::atomic<long> iterations_;
+};
+
+#endif // FORWARDSIMULATOR_H
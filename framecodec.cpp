@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "framecodec.h"
+
+// transposes 8 x 8 bit matrix with rows as bytes, so bit c of byte r becomes bit r of byte c
+static inline uint64_t transpose_bits(uint64_t x) {
+    uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    return x ^ t ^ (t << 28);
+}
+
+// bit plane b holds bit b of all values, one bit per value, groups of eight values
+// are transposed at once as four 8 x 8 bit matrices, one per byte of the values
+static void shuffle_bits(const uint32_t* values, size_t count, uchar* planes) {
+    size_t plane_size = (count + 7) / 8;
+    for (size_t group = 0; group < plane_size; ++group) {
+        uint32_t block[8] = { 0 };
+        std::memcpy(block, values + group * 8, sizeof(uint32_t) * std::min((size_t)8, count - group * 8));
+
+        for (size_t byte = 0; byte < sizeof(uint32_t); ++byte) {
+            uint64_t matrix = 0;
+            for (size_t value = 0; value < 8; ++value) {
+                matrix |= (uint64_t)((block[value] >> (8 * byte)) & 0xff) << (8 * value);
+            }
+            matrix = transpose_bits(matrix);
+            for (size_t bit = 0; bit < 8; ++bit) {
+                planes[(byte * 8 + bit) * plane_size + group] = (uchar)(matrix >> (8 * bit));
+            }
+        }
+    }
+}
+
+static void unshuffle_bits(const uchar* planes, size_t count, uint32_t* values) {
+    size_t plane_size = (count + 7) / 8;
+    for (size_t group = 0; group < plane_size; ++group) {
+        uint32_t block[8] = { 0 };
+        for (size_t byte = 0; byte < sizeof(uint32_t); ++byte) {
+            uint64_t matrix = 0;
+            for (size_t bit = 0; bit < 8; ++bit) {
+                matrix |= (uint64_t)planes[(byte * 8 + bit) * plane_size + group] << (8 * bit);
+            }
+            matrix = transpose_bits(matrix);
+            for (size_t value = 0; value < 8; ++value) {
+                block[value] |= (uint32_t)((matrix >> (8 * value)) & 0xff) << (8 * byte);
+            }
+        }
+
+        std::memcpy(values + group * 8, block, sizeof(uint32_t) * std::min((size_t)8, count - group * 8));
+    }
+}
+
+QByteArray FrameCodec::compress(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+    const Eigen::Ref<const Eigen::ArrayXXf>& frames, int level) {
+    size_t rows = frames.rows();
+    size_t count = frames.rows() * frames.cols();
+
+    // temporal delta of float bit patterns, first frame is kept as is
+    std::vector<uint32_t> bits(count);
+    for (mpFlow::dtype::index frame = 0; frame < frames.cols(); ++frame) {
+        const uint32_t* current = reinterpret_cast<const uint32_t*>(frames.col(frame).data());
+        uint32_t* delta = &bits[frame * rows];
+        if (frame == 0) {
+            std::memcpy(delta, current, sizeof(uint32_t) * rows);
+            continue;
+        }
+
+        const uint32_t* previous = reinterpret_cast<const uint32_t*>(frames.col(frame - 1).data());
+        for (size_t row = 0; row < rows; ++row) {
+            delta[row] = current[row] ^ previous[row];
+        }
+    }
+
+    // shuffle bits into planes followed by time stamp deltas
+    size_t planes_size = 32 * ((count + 7) / 8);
+    QByteArray buffer(planes_size + sizeof(qint64) * timestamps.size(), 0);
+    uchar* planes = reinterpret_cast<uchar*>(buffer.data());
+    shuffle_bits(bits.data(), count, planes);
+
+    std::vector<qint64> timestamp_deltas(timestamps.size());
+    for (mpFlow::dtype::index i = 0; i < timestamps.size(); ++i) {
+        timestamp_deltas[i] = i == 0 ? timestamps(0) : timestamps(i) - timestamps(i - 1);
+    }
+    std::memcpy(planes + planes_size, timestamp_deltas.data(),
+        sizeof(qint64) * timestamp_deltas.size());
+
+    return qCompress(buffer, level);
+}
+
+bool FrameCodec::decompress(const QByteArray& data, Eigen::Ref<Eigen::Array<qint64, Eigen::Dynamic, 1>> timestamps,
+    Eigen::Ref<Eigen::ArrayXXf> frames) {
+    size_t rows = frames.rows();
+    size_t count = frames.rows() * frames.cols();
+
+    size_t planes_size = 32 * ((count + 7) / 8);
+    QByteArray buffer = qUncompress(data);
+    if ((timestamps.size() != frames.cols()) || ((size_t)buffer.size() !=
+        planes_size + sizeof(qint64) * timestamps.size())) {
+        return false;
+    }
+
+    // gather bit planes
+    std::vector<uint32_t> bits(count);
+    const uchar* planes = reinterpret_cast<const uchar*>(buffer.constData());
+    unshuffle_bits(planes, count, bits.data());
+
+    // undo temporal delta frame by frame
+    for (mpFlow::dtype::index frame = 0; frame < frames.cols(); ++frame) {
+        uint32_t* current = reinterpret_cast<uint32_t*>(frames.col(frame).data());
+        const uint32_t* delta = &bits[frame * rows];
+        if (frame == 0) {
+            std::memcpy(current, delta, sizeof(uint32_t) * rows);
+            continue;
+        }
+
+        const uint32_t* previous = reinterpret_cast<const uint32_t*>(frames.col(frame - 1).data());
+        for (size_t row = 0; row < rows; ++row) {
+            current[row] = delta[row] ^ previous[row];
+        }
+    }
+
+    std::vector<qint64> timestamp_deltas(timestamps.size());
+    std::memcpy(timestamp_deltas.data(), planes + planes_size,
+        sizeof(qint64) * timestamp_deltas.size());
+    for (mpFlow::dtype::index i = 0; i < timestamps.size(); ++i) {
+        timestamps(i) = i == 0 ? timestamp_deltas[0] : timestamps(i - 1) + timestamp_deltas[i];
+    }
+
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef FRAMECODEC_H
+#define FRAMECODEC_H
+
+#include <QByteArray>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+
+// lossless codec for blocks of frames, consecutive frames are xor'ed bitwise,
+// which leaves mostly zero sign, exponent and high mantissa bits for slowly
+// changing values, the bits of all values are shuffled into 32 bit planes
+// to group those zeros and the result is entropy coded by zlib
+class FrameCodec {
+public:
+    static QByteArray compress(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+        const Eigen::Ref<const Eigen::ArrayXXf>& frames, int level=1);
+    static bool decompress(const QByteArray& data, Eigen::Ref<Eigen::Array<qint64, Eigen::Dynamic, 1>> timestamps,
+        Eigen::Ref<Eigen::ArrayXXf> frames);
+};
+
+#endif // FRAMECODEC_H
@@ -0,0 +1,65 @@
+#include <QtConcurrent>
+#include <QThread>
+#include <numeric>
+#include <stdexcept>
+#include <atomic>
+#include "frameexporter.h"
+#include "highprecisiontime.h"
+
+FrameExporter::FrameExporter(OffscreenRenderer* renderer, int size) :
+    renderer_(renderer), size_(size) {
+}
+
+double FrameExporter::export_png_sequence(const Eigen::Ref<const Eigen::ArrayXXf>& frames,
+    const QString& base_name, mpFlow::dtype::index first_number) {
+    HighPrecisionTime time;
+
+    // render and save all frames independently on thread pool
+    std::vector<mpFlow::dtype::index> indices(frames.cols());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::atomic<int> failed(0);
+    QtConcurrent::blockingMap(indices, [&](mpFlow::dtype::index frame) {
+        QImage image = this->renderer()->render(frames.col(frame), this->size());
+        if (!image.save(QString("%1_%2.png").arg(base_name).arg(first_number + frame, 6, 10, QChar('0')), "PNG")) {
+            failed += 1;
+        }
+    });
+
+    if (failed > 0) {
+        throw std::runtime_error("FrameExporter::export_png_sequence: cannot save images");
+    }
+
+    return (double)frames.cols() / time.elapsed();
+}
+
+double FrameExporter::export_raw_video(const Eigen::Ref<const Eigen::ArrayXXf>& frames,
+    QIODevice* device) {
+    if ((device == nullptr) || !device->isWritable()) {
+        throw std::invalid_argument("FrameExporter::export_raw_video: device not writable");
+    }
+
+    HighPrecisionTime time;
+
+    // render chunks of frames in parallel and write them in order
+    mpFlow::dtype::index chunk_size = 2 * QThread::idealThreadCount();
+    for (mpFlow::dtype::index chunk = 0; chunk < frames.cols(); chunk += chunk_size) {
+        std::vector<mpFlow::dtype::index> indices(std::min(chunk_size, (mpFlow::dtype::index)frames.cols() - chunk));
+        std::iota(indices.begin(), indices.end(), chunk);
+        std::function<QImage(const mpFlow::dtype::index&)> render_frame = [&](const mpFlow::dtype::index& frame) {
+            return this->renderer()->render(frames.col(frame), this->size())
+                .convertToFormat(QImage::Format_RGB888);
+        };
+        QList<QImage> images = QtConcurrent::blockingMapped<QList<QImage>>(indices, render_frame);
+
+        // write tightly packed scan lines
+        for (const auto& image : images)
+        for (int line = 0; line < image.height(); ++line) {
+            if (device->write((const char*)image.constScanLine(line), image.width() * 3) !=
+                image.width() * 3) {
+                throw std::runtime_error("FrameExporter::export_raw_video: cannot write frame");
+            }
+        }
+    }
+
+    return (double)frames.cols() / time.elapsed();
+}
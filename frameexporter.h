@@ -0,0 +1,29 @@
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include <QString>
+#include <QIODevice>
+#include "offscreenrenderer.h"
+
+// renders reconstructed frame streams with the offscreen renderer in parallel
+// on all cores and writes them as png sequence or raw rgb24 video stream
+class FrameExporter {
+public:
+    FrameExporter(OffscreenRenderer* renderer, int size);
+
+    double export_png_sequence(const Eigen::Ref<const Eigen::ArrayXXf>& frames,
+        const QString& base_name, mpFlow::dtype::index first_number=0);
+    double export_raw_video(const Eigen::Ref<const Eigen::ArrayXXf>& frames,
+        QIODevice* device);
+
+public:
+    // accessors
+    OffscreenRenderer* renderer() { return this->renderer_; }
+    int& size() { return this->size_; }
+
+private:
+    OffscreenRenderer* renderer_;
+    int size_;
+};
+
+#endif // FRAMEEXPORTER_H
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cstring>
+#include "framehistory.h"
+#include "mirrorprotocol.h"
+
+FrameHistory::FrameHistory(double duration, size_t max_bytes) :
+    duration_(duration), max_bytes_(max_bytes), max_capacity_(0), first_(0), size_(0) {
+}
+
+void FrameHistory::reset(mpFlow::dtype::index rows) {
+    // as many frames as fit into memory bound, storage is allocated on demand
+    this->max_capacity() = rows == 0 ? 0 : std::max((size_t)1,
+        this->max_bytes() / (sizeof(float) * rows + sizeof(quint64) + sizeof(qint64)));
+    this->values().resize(rows, 0);
+    this->frame_ids().resize(0);
+    this->timestamps().resize(0);
+    this->first() = 0;
+    this->size() = 0;
+}
+
+void FrameHistory::push(quint64 frame_id, qint64 timestamp,
+    const Eigen::Ref<const Eigen::ArrayXf>& values) {
+    if ((this->max_capacity() == 0) || (values.size() != this->rows())) {
+        return;
+    }
+
+    // drop frames older than duration
+    while ((this->size() > 0) && (this->timestamps()(this->first()) <
+        timestamp - (qint64)(this->duration() * 1e3))) {
+        this->first() = (this->first() + 1) % this->capacity();
+        this->size() -= 1;
+    }
+
+    // grow storage, until memory bound is reached, drop oldest frame afterwards
+    if ((this->size() == this->capacity()) && (this->capacity() < this->max_capacity())) {
+        this->grow();
+    }
+    if (this->size() == this->capacity()) {
+        this->first() = (this->first() + 1) % this->capacity();
+        this->size() -= 1;
+    }
+
+    mpFlow::dtype::index slot = this->slot(this->size());
+    this->values().col(slot) = values;
+    this->frame_ids()(slot) = frame_id;
+    this->timestamps()(slot) = timestamp;
+    this->size() += 1;
+}
+
+void FrameHistory::grow() {
+    mpFlow::dtype::index capacity = std::min(this->max_capacity(),
+        std::max((mpFlow::dtype::index)16, 2 * this->capacity()));
+
+    // copy held frames in order, oldest one to first column
+    Eigen::ArrayXXf values(this->rows(), capacity);
+    Eigen::Array<quint64, Eigen::Dynamic, 1> frame_ids(capacity);
+    Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps(capacity);
+    for (mpFlow::dtype::index position = 0; position < this->size(); ++position) {
+        mpFlow::dtype::index slot = this->slot(position);
+        values.col(position) = this->values().col(slot);
+        frame_ids(position) = this->frame_ids()(slot);
+        timestamps(position) = this->timestamps()(slot);
+    }
+
+    this->values().swap(values);
+    this->frame_ids().swap(frame_ids);
+    this->timestamps().swap(timestamps);
+    this->first() = 0;
+}
+
+QByteArray FrameHistory::batch(quint64 since) {
+    // frame ids are increasing, so binary search first frame after since
+    mpFlow::dtype::index begin = 0, end = this->size();
+    while (begin < end) {
+        mpFlow::dtype::index middle = (begin + end) / 2;
+        if (this->frame_ids()(this->slot(middle)) <= since) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    mpFlow::dtype::index count = this->size() - begin;
+
+    mirrorprotocol::BatchHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = mirrorprotocol::batch_magic;
+    header.frame_count = count;
+    header.rows = this->rows();
+    if (count > 0) {
+        header.first_frame_id = this->frame_ids()(this->slot(begin));
+        header.last_frame_id = this->frame_ids()(this->slot(this->size() - 1));
+    }
+
+    // serialize into one preallocated buffer
+    size_t frame_size = sizeof(quint64) + sizeof(qint64) + sizeof(float) * this->rows();
+    QByteArray batch(sizeof(header) + count * frame_size, Qt::Uninitialized);
+    char* data = batch.data();
+    std::memcpy(data, &header, sizeof(header));
+    data += sizeof(header);
+    for (mpFlow::dtype::index position = begin; position < this->size(); ++position) {
+        mpFlow::dtype::index slot = this->slot(position);
+        std::memcpy(data, &this->frame_ids()(slot), sizeof(quint64));
+        std::memcpy(data + sizeof(quint64), &this->timestamps()(slot), sizeof(qint64));
+        std::memcpy(data + sizeof(quint64) + sizeof(qint64), this->values().col(slot).data(),
+            sizeof(float) * this->rows());
+        data += frame_size;
+    }
+
+    return batch;
+}
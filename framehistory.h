@@ -0,0 +1,53 @@
+#ifndef FRAMEHISTORY_H
+#define FRAMEHISTORY_H
+
+#include <QByteArray>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+
+// ring of the most recently reconstructed frames, bounded by age and
+// memory, storage grows geometrically with the number of held frames up
+// to the memory bound, so pushing a frame only allocates while growing
+class FrameHistory {
+public:
+    explicit FrameHistory(double duration=10.0, size_t max_bytes=64 * 1024 * 1024);
+
+    void reset(mpFlow::dtype::index rows);
+    void push(quint64 frame_id, qint64 timestamp, const Eigen::Ref<const Eigen::ArrayXf>& values);
+
+    // all frames with id greater than given one as one batch message
+    QByteArray batch(quint64 since);
+
+    // storage column of frame at given position, oldest frame is at position 0
+    mpFlow::dtype::index slot(mpFlow::dtype::index position) {
+        return (this->first() + position) % this->capacity();
+    }
+
+protected:
+    void grow();
+
+public:
+    // accessors
+    double duration() { return this->duration_; }
+    size_t max_bytes() { return this->max_bytes_; }
+    mpFlow::dtype::index rows() { return this->values_.rows(); }
+    mpFlow::dtype::index capacity() { return this->values_.cols(); }
+    mpFlow::dtype::index& max_capacity() { return this->max_capacity_; }
+    mpFlow::dtype::index& first() { return this->first_; }
+    mpFlow::dtype::index& size() { return this->size_; }
+    Eigen::ArrayXXf& values() { return this->values_; }
+    Eigen::Array<quint64, Eigen::Dynamic, 1>& frame_ids() { return this->frame_ids_; }
+    Eigen::Array<qint64, Eigen::Dynamic, 1>& timestamps() { return this->timestamps_; }
+
+private:
+    double duration_;
+    size_t max_bytes_;
+    mpFlow::dtype::index max_capacity_;
+    mpFlow::dtype::index first_;
+    mpFlow::dtype::index size_;
+    Eigen::ArrayXXf values_;
+    Eigen::Array<quint64, Eigen::Dynamic, 1> frame_ids_;
+    Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps_;
+};
+
+#endif // FRAMEHISTORY_H
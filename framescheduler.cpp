@@ -0,0 +1,71 @@
+#include <algorithm>
+#include "framescheduler.h"
+
+// number of per frame latencies kept for inspection
+static const size_t latency_history_size = 4096;
+
+// rate at which the playout delay shrinks again after a late batch
+static const double playout_delay_decay = 0.01;
+
+FrameScheduler::FrameScheduler() {
+    this->reset();
+}
+
+void FrameScheduler::reset() {
+    this->queue().clear();
+    this->latencies().clear();
+    this->latencies().reserve(latency_history_size);
+    this->playout_delay() = 0.0;
+    this->frame_rate() = 0.0;
+    this->latency() = 0.0;
+    this->presented_frames() = 0;
+    this->dropped_frames() = 0;
+}
+
+void FrameScheduler::push(std::shared_ptr<RenderFrames> frames, double time_elapsed,
+    double arrival_time) {
+    if ((frames == nullptr) || (frames->timestamps.size() == 0)) {
+        return;
+    }
+
+    // the playout delay has to cover the age of the oldest frame of a batch on arrival,
+    // so that all frames of a batch can be presented evenly spaced
+    double age = arrival_time - frames->timestamps(0);
+    this->playout_delay() = std::max(age, this->playout_delay() -
+        playout_delay_decay * (this->playout_delay() - age));
+    this->frame_rate() = time_elapsed > 0.0 ? (double)frames->timestamps.size() / time_elapsed : 0.0;
+
+    // schedule all frames of batch
+    for (mpFlow::dtype::index column = 0; column < frames->timestamps.size(); ++column) {
+        Frame frame = { frames, column, frames->timestamps(column),
+            frames->timestamps(column) + this->playout_delay() };
+        this->queue().push_back(frame);
+    }
+}
+
+bool FrameScheduler::next_frame(double presentation_time, Frame* frame) {
+    // take newest frame due until presentation time and drop all older ones deliberately
+    bool found = false;
+    while (!this->queue().empty() && (this->queue().front().deadline <= presentation_time)) {
+        if (found) {
+            this->dropped_frames() += 1;
+        }
+        *frame = this->queue().front();
+        this->queue().pop_front();
+        found = true;
+    }
+
+    return found;
+}
+
+void FrameScheduler::presented(const Frame& frame, double presentation_time) {
+    this->latency() = presentation_time - frame.acquisition_time;
+    this->presented_frames() += 1;
+
+    // keep ring of recent latencies
+    if (this->latencies().size() < latency_history_size) {
+        this->latencies().push_back(this->latency());
+    } else {
+        this->latencies()[this->presented_frames() % latency_history_size] = this->latency();
+    }
+}
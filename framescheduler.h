@@ -0,0 +1,49 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mpflow/mpflow.h>
+#include "renderpreparer.h"
+
+// assigns each reconstructed frame a presentation deadline derived from its
+// acquisition time stamp, drops frames which missed their deadline and
+// records the measured acquisition to presentation latency of each frame
+class FrameScheduler {
+public:
+    struct Frame {
+        std::shared_ptr<RenderFrames> frames;
+        mpFlow::dtype::index column;
+        double acquisition_time;
+        double deadline;
+    };
+
+    FrameScheduler();
+
+    void reset();
+    void push(std::shared_ptr<RenderFrames> frames, double time_elapsed, double arrival_time);
+    bool next_frame(double presentation_time, Frame* frame);
+    void presented(const Frame& frame, double presentation_time);
+
+public:
+    // accessors
+    std::deque<Frame>& queue() { return this->queue_; }
+    std::vector<double>& latencies() { return this->latencies_; }
+    double& playout_delay() { return this->playout_delay_; }
+    double& frame_rate() { return this->frame_rate_; }
+    double& latency() { return this->latency_; }
+    qint64& presented_frames() { return this->presented_frames_; }
+    qint64& dropped_frames() { return this->dropped_frames_; }
+
+private:
+    std::deque<Frame> queue_;
+    std::vector<double> latencies_;
+    double playout_delay_;
+    double frame_rate_;
+    double latency_;
+    qint64 presented_frames_;
+    qint64 dropped_frames_;
+};
+
+#endif // FRAMESCHEDULER_H
@@ -1,3 +1,4 @@
+#include <QDateTime>
 #include "highprecisiontime.h"
 
 HighPrecisionTime::HighPrecisionTime(QObject *parent) :
@@ -16,3 +17,17 @@ double HighPrecisionTime::elapsed() {
         std::chrono::high_resolution_clock::now() - this->start_time_)
         .count();
 }
+
+double HighPrecisionTime::now() {
+    return std::chrono::duration_cast<std::chrono::duration<double>>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 HighPrecisionTime::ticks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 HighPrecisionTime::wall_clock(double timestamp) {
+    return QDateTime::currentMSecsSinceEpoch() - (qint64)((HighPrecisionTime::now() - timestamp) * 1e3);
+}
@@ -12,6 +12,15 @@ public:
     void restart();
     double elapsed();
 
+    // monotonic time stamp in seconds, common to all threads
+    static double now();
+
+    // same monotonic clock in integer nanoseconds, e.g. for profiler events
+    static qint64 ticks();
+
+    // wall clock time in ms since epoch of given monotonic time stamp
+    static qint64 wall_clock(double timestamp);
+
 private:
    std::chrono::high_resolution_clock::time_point start_time_;
 };
@@ -1,188 +1,319 @@
 #include <algorithm>
 #include <cmath>
+#include <vector>
+#include <QGuiApplication>
+#include <QScreen>
 #include "image.h"
+#include "colormap.h"
+#include "profiler.h"
+
+#ifndef GL_R32F
+#define GL_R32F 0x822E
+#endif
+
+// width of the 2D texture holding one normalized value per element
+static const GLsizei element_value_texture_width = 2048;
+
+// vertex shader lifts each node by its normalized z value
+static const char* vertex_shader_source = R"(
+#version 120
+attribute vec2 position;
+attribute float value;
+varying float node_value;
+
+void main() {
+    node_value = value;
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(position, 1.0 - 2.0 * value, 1.0);
+}
+)";
+
+// fragment shader applies jet colormap either to interpolated node values
+// or to per element values fetched by primitive id
+static const char* fragment_shader_source = R"(
+#version 120
+#extension GL_EXT_gpu_shader4 : require
+uniform sampler1D colormap;
+uniform sampler2D element_values;
+uniform int element_values_width;
+uniform int color_mode;
+varying float node_value;
+
+void main() {
+    if (color_mode == 2) {
+        gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+    } else if (color_mode == 1) {
+        gl_FragColor = texture1D(colormap, node_value);
+    } else {
+        float value = texelFetch2D(element_values, ivec2(gl_PrimitiveID % element_values_width,
+            gl_PrimitiveID / element_values_width), 0).r;
+        gl_FragColor = texture1D(colormap, value);
+    }
+}
+)";
 
 Image::Image(QWidget* parent) :
-    QGLWidget(parent), threashold_(0.1), image_pos_(0.0), image_increment_(0.0),
-    sigma_ref_(0.0), draw_wireframe_(false), interpolate_colors_(false) {
-    // create timer
+    QGLWidget(parent), threashold_(0.1), vsync_interval_(1.0 / 60.0), swap_time_(0.0),
+    frames_(std::make_shared<RenderFrames>()), frame_(0), frame_id_(0), mesh_generation_(0),
+    gui_frame_time_(0.0), upload_time_(0.0),
+    sigma_ref_(0.0), draw_wireframe_(false), interpolate_colors_(false),
+    shader_program_(nullptr), z_value_buffer_(QGLBuffer::VertexBuffer),
+    mesh_lod_(nullptr), lod_level_(0), latency_tracer_(nullptr),
+    colormap_texture_(0), element_value_texture_(0), gl_buffer_created_(false),
+    gl_buffer_dirty_(false) {
+    // presentation loop is paced by the blocking buffer swap with swap interval 1,
+    // the single shot timer only returns control to the event loop between swaps
+    if ((QGuiApplication::primaryScreen() != nullptr) &&
+        (QGuiApplication::primaryScreen()->refreshRate() > 0.0)) {
+        this->vsync_interval() = 1.0 / QGuiApplication::primaryScreen()->refreshRate();
+    }
     this->draw_timer_ = new QTimer(this);
+    this->draw_timer().setTimerType(Qt::PreciseTimer);
+    this->draw_timer().setSingleShot(true);
     connect(this->draw_timer_, &QTimer::timeout, this, &Image::update_gl_buffer);
 
+    // create render preparer, which converts complete batches to ready to draw buffers
+    this->render_preparer_ = new RenderPreparer();
+    connect(this->render_preparer(), &RenderPreparer::frames_ready, this, &Image::update_frames);
+
     // init view
     this->reset_view();
 }
 
 Image::~Image() {
     this->cleanup();
+
+    // stop render preparer
+    this->render_preparer()->thread()->quit();
+    this->render_preparer()->thread()->wait();
+    delete this->render_preparer();
+
+    // release textures
+    this->makeCurrent();
+    if (this->colormap_texture_ != 0) {
+        glDeleteTextures(1, &this->colormap_texture_);
+    }
+    if (this->element_value_texture_ != 0) {
+        glDeleteTextures(1, &this->element_value_texture_);
+    }
 }
 
 void Image::init(std::shared_ptr<mpFlow::EIT::model::Base> model,
+    mpFlow::dtype::index rows, mpFlow::dtype::index columns) {
+    // node positions interleaved and scaled to unit radius
+    Eigen::ArrayXXf nodes = mpFlow::numeric::matrix::toEigen<mpFlow::dtype::real>(
+        model->mesh()->nodes()).leftCols(2).transpose() / model->mesh()->radius();
+
+    // electrode start and end points scaled to unit radius
+    Eigen::ArrayXXf electrodes = Eigen::ArrayXXf::Zero(2 * 2, model->electrodes()->count());
+    for (mpFlow::dtype::index electrode = 0; electrode < model->electrodes()->count(); ++electrode) {
+        electrodes(0 * 2 + 0, electrode) = std::get<0>(std::get<0>(
+            model->electrodes()->coordinates(electrode))) / model->mesh()->radius();
+        electrodes(0 * 2 + 1, electrode) = std::get<1>(std::get<0>(
+            model->electrodes()->coordinates(electrode))) / model->mesh()->radius();
+        electrodes(1 * 2 + 0, electrode) = std::get<0>(std::get<1>(
+            model->electrodes()->coordinates(electrode))) / model->mesh()->radius();
+        electrodes(1 * 2 + 1, electrode) = std::get<1>(std::get<1>(
+            model->electrodes()->coordinates(electrode))) / model->mesh()->radius();
+    }
+
+    this->init(nodes, mpFlow::numeric::matrix::toEigen<mpFlow::dtype::index>(
+        model->mesh()->elements()), electrodes, model->sigma_ref(), rows, columns);
+}
+
+void Image::init(const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::ArrayXXf& electrodes, mpFlow::dtype::real sigma_ref,
     mpFlow::dtype::index rows, mpFlow::dtype::index columns) {
     // cleanup
     this->cleanup();
 
     // create arrays
-    this->data() = Eigen::ArrayXXf::Ones(rows, columns) * model->sigma_ref();
-    this->vertices() = Eigen::ArrayXXf::Zero(3 * 3, model->mesh()->elements()->rows());
-    this->colors() = Eigen::ArrayXXf::Zero(3 * 3, model->mesh()->elements()->rows());
-    this->interpolated_colors() = Eigen::ArrayXXf::Zero(model->mesh()->nodes()->rows(), 3);
-    this->electrodes() = Eigen::ArrayXXf::Zero(2 * 2, model->electrodes()->count());
-    this->electrode_colors() = Eigen::ArrayXXf::Zero(3 * 2, model->electrodes()->count());
-    this->elements() = mpFlow::numeric::matrix::toEigen<mpFlow::dtype::index>(
-        model->mesh()->elements());
-    this->z_values() = Eigen::ArrayXf::Zero(model->mesh()->nodes()->rows());
-    this->element_area() = Eigen::ArrayXf::Zero(model->mesh()->elements()->rows());
-    this->node_area() = Eigen::ArrayXf::Zero(model->mesh()->nodes()->rows());
+    this->nodes() = nodes;
+    this->elements() = elements;
+    this->electrodes() = electrodes;
+    this->electrode_colors() = Eigen::ArrayXXf::Zero(3 * 2, electrodes.cols());
+    this->element_area() = Eigen::ArrayXf::Zero(elements.rows());
+    this->node_area() = Eigen::ArrayXf::Zero(nodes.cols());
 
     // calc node and element area
-    Eigen::ArrayXXf nodes = mpFlow::numeric::matrix::toEigen<mpFlow::dtype::real>(model->mesh()->nodes());
     for (mpFlow::dtype::index element = 0; element < this->elements().rows(); ++element) {
         this->element_area()(element) = 0.5 * std::abs(
-            (nodes(this->elements()(element, 1), 0) - nodes(this->elements()(element, 0), 0)) *
-            (nodes(this->elements()(element, 2), 1) - nodes(this->elements()(element, 0), 1)) -
-            (nodes(this->elements()(element, 2), 0) - nodes(this->elements()(element, 0), 0)) *
-            (nodes(this->elements()(element, 1), 1) - nodes(this->elements()(element, 0), 1)));
+            (nodes(0, this->elements()(element, 1)) - nodes(0, this->elements()(element, 0))) *
+            (nodes(1, this->elements()(element, 2)) - nodes(1, this->elements()(element, 0))) -
+            (nodes(0, this->elements()(element, 2)) - nodes(0, this->elements()(element, 0))) *
+            (nodes(1, this->elements()(element, 1)) - nodes(1, this->elements()(element, 0))));
 
         for (mpFlow::dtype::index node = 0; node < 3; ++node) {
             this->node_area()(this->elements()(element, node)) += this->element_area()(element);
         }
     }
 
-    // fill vertex buffer
+    // create sparse operator averaging element values to nodes with area weights folded in
+    std::vector<Eigen::Triplet<float>> node_averaging_weights;
+    node_averaging_weights.reserve(this->elements().rows() * 3);
     for (mpFlow::dtype::index element = 0; element < this->elements().rows(); ++element)
     for (mpFlow::dtype::index node = 0; node < 3; ++node) {
-        this->vertices()(node * 3 + 0, element) =
-            nodes(this->elements()(element, node), 0) / model->mesh()->radius();
-        this->vertices()(node * 3 + 1, element) =
-            nodes(this->elements()(element, node), 1) / model->mesh()->radius();
-    }
-
-    // fill electrodes buffer
-    for (mpFlow::dtype::index electrode = 0; electrode < model->electrodes()->count(); ++electrode) {
-        this->electrodes()(0 * 2 + 0, electrode) = std::get<0>(std::get<0>(
-            model->electrodes()->coordinates(electrode))) / model->mesh()->radius();
-        this->electrodes()(0 * 2 + 1, electrode) = std::get<1>(std::get<0>(
-            model->electrodes()->coordinates(electrode))) / model->mesh()->radius();
-        this->electrodes()(1 * 2 + 0, electrode) = std::get<0>(std::get<1>(
-            model->electrodes()->coordinates(electrode))) / model->mesh()->radius();
-        this->electrodes()(1 * 2 + 1, electrode) = std::get<1>(std::get<1>(
-            model->electrodes()->coordinates(electrode))) / model->mesh()->radius();
+        node_averaging_weights.push_back(Eigen::Triplet<float>(
+            this->elements()(element, node), element,
+            this->element_area()(element) / this->node_area()(this->elements()(element, node))));
     }
+    this->node_averaging().resize(this->node_area().rows(), this->element_area().rows());
+    this->node_averaging().setFromTriplets(node_averaging_weights.begin(),
+        node_averaging_weights.end());
 
     // mark first electrode red
-    this->electrode_colors()(0, 0) = this->electrode_colors()(3, 0) = 1.0;
+    if (this->electrodes().cols() > 0) {
+        this->electrode_colors()(0, 0) = this->electrode_colors()(3, 0) = 1.0;
+    }
 
     // save sigma ref
-    this->sigma_ref() = model->sigma_ref();
-
-    // redraw
-    this->update_gl_buffer();
+    this->sigma_ref() = sigma_ref;
+
+    // build simplified display meshes
+    this->mesh_lod() = std::make_shared<MeshLOD>(this->nodes(), this->elements(),
+        this->node_area(), this->element_area());
+
+    // element values are padded to fill complete rows of the element value texture
+    this->render_preparer()->init(this->node_averaging(), this->mesh_lod(), this->sigma_ref(),
+        element_value_texture_width, this->mesh_generation());
+    this->update_lod_level();
+
+    // prepare initial homogeneous frames
+    auto frames = std::make_shared<RenderFrames>();
+    frames->data = Eigen::ArrayXXf::Ones(rows, columns) * this->sigma_ref();
+    frames->mesh_generation = this->mesh_generation();
+    frames->element_values = Eigen::ArrayXXf::Zero(RenderPreparer::aligned_rows(
+        this->elements().rows(), element_value_texture_width), columns);
+    frames->z_values = Eigen::ArrayXXf::Zero(this->node_area().rows(), columns);
+    RenderPreparer::prepare(frames->data, this->node_averaging(), this->sigma_ref(),
+        this->threashold(), frames->element_values, frames->z_values);
+    this->frames() = frames;
+    this->frame() = 0;
+
+    // mirror clients work on their own copy of the mesh
+    this->publish_mesh();
+
+    // redraw and start presenting frames
+    this->gl_buffer_dirty_ = true;
     this->updateGL();
+    this->swap_time() = HighPrecisionTime::now();
+    this->draw_timer().start(0);
 }
 
 void Image::cleanup() {
     // stop timer
     this->draw_timer().stop();
 
-    // reset image buffer pos and increment
-    this->image_pos() = 0.0;
-    this->image_increment() = 0.0;
+    // batches still queued for the old mesh are dropped on arrival
+    this->mesh_generation() += 1;
+
+    // reset scheduled frames
+    this->frame_scheduler().reset();
+    this->frames() = std::make_shared<RenderFrames>();
+    this->frame() = 0;
 
     // clear vertex buffer
-    this->vertices() = Eigen::ArrayXXf();
+    this->nodes() = Eigen::ArrayXXf();
+    this->elements().resize(0, 3);
     this->electrodes() = Eigen::ArrayXXf();
+    this->mesh_lod() = nullptr;
+    this->lod_level() = 0;
+    this->gl_buffer_created_ = false;
+    this->publish_mesh();
 
     // reset view
     this->reset_view();
 }
 
+void Image::publish_mesh() {
+    auto mesh = std::make_shared<MirrorMesh>();
+    mesh->nodes = this->nodes();
+    mesh->elements = this->elements();
+    mesh->electrodes = this->electrodes();
+    mesh->electrode_colors = this->electrode_colors();
+
+    emit this->mesh_changed(mesh);
+}
+
+void Image::publish_frame(double presentation_time) {
+    // notify mirror clients about each presented frame exactly once, the
+    // snapshot shares the prepared buffers of the batch, which are never modified
+    this->frame_id() += 1;
+    auto snapshot = std::make_shared<MirrorFrame>();
+    snapshot->frame_id = this->frame_id();
+    snapshot->frames = this->frames();
+    snapshot->column = this->frame();
+    snapshot->interpolate_colors = this->interpolate_colors();
+    snapshot->presentation_time = presentation_time;
+    emit this->frame_presented(snapshot);
+}
+
 void Image::reset_view() {
     this->view_angle()[0] = 0.0;
     this->view_angle()[1] = 0.0;
     this->threashold() = 0.02;
+    this->render_preparer()->set_threashold(this->threashold());
 
     this->updateGL();
 }
 
-void Image::update_data(Eigen::ArrayXXf data, double time_elapsed) {
-    this->data() = data;
-
-    // update image increments
-    this->image_pos() = 0.0;
-    this->image_increment() = time_elapsed > 0.02 ? 0.02 / time_elapsed *
-        (double)this->data().cols() : 0.0;
+void Image::update_frames(std::shared_ptr<RenderFrames> frames, double time_elapsed) {
+    if (frames->mesh_generation != this->mesh_generation()) {
+        return;
+    }
 
-    // start draw timer
-    this->draw_timer().start(20);
+    // schedule all frames of batch for presentation
+    this->frame_scheduler().push(frames, time_elapsed, HighPrecisionTime::now());
 }
 
 void Image::update_gl_buffer() {
-    // calc norm and prevent division by zero
-    mpFlow::dtype::real norm = std::max(std::max(
-        -(this->data().col(this->image_pos()) - this->sigma_ref()).minCoeff(),
-        (this->data().col(this->image_pos()) - this->sigma_ref()).maxCoeff()),
-        this->threashold() * this->sigma_ref());
-    norm = norm == 0.0 ? 1.0 : norm;
-
-    // subtract reference conductivity and normalize current data set to a range between 0.0 and 1.0
-    auto normalized_data = 0.5 * (this->data().col(this->image_pos())
-        - this->sigma_ref()) / norm + 0.5;
-
-    // calc z values
-    this->z_values().setZero();
-    for (mpFlow::dtype::index element = 0; element < this->elements().rows(); ++element)
-    for (mpFlow::dtype::index node = 0; node < 3; ++node) {
-        this->z_values()(this->elements()(element, node)) +=
-            normalized_data(element) * this->element_area()(element) /
-            this->node_area()(this->elements()(element, node));
+    PROFILE_ZONE("render present");
+
+    // get frame due at next vsync, all buffers were already prepared by render preparer,
+    // without a due frame the current one is drawn again to keep the loop on vsync
+    FrameScheduler::Frame frame;
+    bool due = this->frame_scheduler().next_frame(HighPrecisionTime::now() + this->vsync_interval(),
+        &frame);
+    double swap_pointer_time = 0.0;
+    if (due) {
+        this->frame_time().restart();
+        this->frames() = frame.frames;
+        this->frame() = frame.column;
+        this->gl_buffer_dirty_ = true;
+        swap_pointer_time = this->frame_time().elapsed();
     }
+    this->upload_time() = 0.0;
 
-    // copy z values to opengl vertex buffer
-    for (mpFlow::dtype::index element = 0; element < this->elements().rows(); ++element)
-    for (mpFlow::dtype::index node = 0; node < 3; ++node) {
-        this->vertices()(node * 3 + 2, element) = -(2.0 *
-            this->z_values()(this->elements()(element, node)) - 1.0);
+    // redraw and wait for buffer swap, glFinish blocks until the swap
+    // queued by updateGL was executed on the next vsync
+    double paint_time = HighPrecisionTime::now();
+    this->updateGL();
+    this->makeCurrent();
+    glFinish();
+    double presentation_time = HighPrecisionTime::now();
+
+    // swaps of hidden windows or drivers ignoring the swap interval return
+    // immediately, wait for the remaining refresh interval in that case
+    double remaining = this->swap_time() + this->vsync_interval() - presentation_time;
+    this->swap_time() = presentation_time;
+    this->draw_timer().start(remaining > 0.25 * this->vsync_interval() ? (int)(remaining * 1e3) : 0);
+
+    if (!due) {
+        return;
     }
+    this->frame_scheduler().presented(frame, presentation_time);
 
-    // calc colors
-    if (this->interpolate_colors()) {
-        this->interpolated_colors().col(0) =
-            (-4.0 * (this->z_values() - 0.75).abs() + 1.5).max(0.0).min(1.0);
-        this->interpolated_colors().col(1) =
-            (-4.0 * (this->z_values() - 0.5).abs() + 1.5).max(0.0).min(1.0);
-        this->interpolated_colors().col(2) =
-            (-4.0 * (this->z_values() - 0.25).abs() + 1.5).max(0.0).min(1.0);
-
-        for (mpFlow::dtype::index element = 0; element < this->elements().rows(); ++element)
-        for (mpFlow::dtype::index node = 0; node < 3; ++node) {
-            this->colors()(node * 3 + 0, element) =
-                this->interpolated_colors()(this->elements()(element, node), 0);
-            this->colors()(node * 3 + 1, element) =
-                this->interpolated_colors()(this->elements()(element, node), 1);
-            this->colors()(node * 3 + 2, element) =
-                this->interpolated_colors()(this->elements()(element, node), 2);
-        }
-    } else {
-        this->colors().row(0) = this->colors().row(3) = this->colors().row(6) =
-            (-4.0 * (normalized_data - 0.75).abs() + 1.5).max(0.0).min(1.0);
-        this->colors().row(1) = this->colors().row(4) = this->colors().row(7) =
-            (-4.0 * (normalized_data - 0.5).abs() + 1.5).max(0.0).min(1.0);
-        this->colors().row(2) = this->colors().row(5) = this->colors().row(8) =
-            (-4.0 * (normalized_data - 0.25).abs() + 1.5).max(0.0).min(1.0);
+    // latencies of all pipeline stages of presented frame
+    if ((this->latency_tracer() != nullptr) && (frame.frames->trace != nullptr)) {
+        this->latency_tracer()->record(*frame.frames->trace, frame.column, paint_time,
+            presentation_time);
     }
 
-    // update image pos
-    this->image_pos() += this->image_increment();
-    if (this->image_pos() >= (double)this->data().cols()) {
-        this->image_pos() = (double)this->data().cols() - 1.0;
+    this->publish_frame(presentation_time);
 
-        // stop draw timer
-        this->draw_timer().stop();
-    }
-
-    // redraw
-    this->updateGL();
+    // gui work per frame is the buffer pointer swap and the upload, paint and
+    // vsync wait are covered by the paint stage of the latency tracer
+    this->gui_frame_time() = swap_pointer_time + this->upload_time();
 }
 
 void Image::set_draw_wireframe(bool draw_wireframe) {
@@ -192,7 +323,7 @@ void Image::set_draw_wireframe(bool draw_wireframe) {
 
 void Image::set_interpolate_colors(bool interpolate_colors) {
     this->interpolate_colors_ = interpolate_colors;
-    this->update_gl_buffer();
+    this->gl_buffer_dirty_ = true;
     this->updateGL();
 }
 
@@ -201,16 +332,134 @@ void Image::initializeGL() {
     glEnable(GL_MULTISAMPLE);
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LEQUAL);
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glEnableClientState(GL_COLOR_ARRAY);
+
+    // compile mesh shader
+    this->shader_program_ = new QGLShaderProgram(this->context(), this);
+    this->shader_program()->addShaderFromSourceCode(QGLShader::Vertex, vertex_shader_source);
+    this->shader_program()->addShaderFromSourceCode(QGLShader::Fragment, fragment_shader_source);
+    this->shader_program()->link();
+
+    // upload jet colormap as 1D texture
+    Eigen::ArrayXXf colormap_table = colormap::jet_table();
+    glGenTextures(1, &this->colormap_texture_);
+    glBindTexture(GL_TEXTURE_1D, this->colormap_texture_);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB, colormap::table_size, 0, GL_RGB, GL_FLOAT,
+        colormap_table.data());
+    glBindTexture(GL_TEXTURE_1D, 0);
+
+    // element values are fetched without filtering
+    glGenTextures(1, &this->element_value_texture_);
+    glBindTexture(GL_TEXTURE_2D, this->element_value_texture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Image::create_gl_buffer() {
+    // static node positions and element indices over shared nodes of all levels of detail
+    for (auto& buffer : this->node_buffers()) {
+        buffer.destroy();
+    }
+    for (auto& buffer : this->index_buffers()) {
+        buffer.destroy();
+    }
+    this->node_buffers().clear();
+    this->index_buffers().clear();
+    for (auto& level : this->mesh_lod()->levels()) {
+        QGLBuffer node_buffer(QGLBuffer::VertexBuffer);
+        node_buffer.create();
+        node_buffer.setUsagePattern(QGLBuffer::StaticDraw);
+        node_buffer.bind();
+        node_buffer.allocate(level.nodes.data(), sizeof(float) * level.nodes.size());
+        node_buffer.release();
+        this->node_buffers().push_back(node_buffer);
+
+        Eigen::Array<GLuint, Eigen::Dynamic, Eigen::Dynamic> indices =
+            level.elements.transpose().cast<GLuint>();
+        QGLBuffer index_buffer(QGLBuffer::IndexBuffer);
+        index_buffer.create();
+        index_buffer.setUsagePattern(QGLBuffer::StaticDraw);
+        index_buffer.bind();
+        index_buffer.allocate(indices.data(), sizeof(GLuint) * indices.size());
+        index_buffer.release();
+        this->index_buffers().push_back(index_buffer);
+    }
+
+    // dynamic z values, one scalar per node of full resolution mesh
+    this->z_value_buffer().destroy();
+    this->z_value_buffer().create();
+    this->z_value_buffer().setUsagePattern(QGLBuffer::DynamicDraw);
+    this->z_value_buffer().bind();
+    this->z_value_buffer().allocate(sizeof(float) * this->z_values().size());
+    this->z_value_buffer().release();
+
+    // storage for element values
+    glBindTexture(GL_TEXTURE_2D, this->element_value_texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, element_value_texture_width,
+        this->element_values().size() / element_value_texture_width, 0, GL_RED, GL_FLOAT,
+        this->element_values().data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    this->gl_buffer_created_ = true;
+    this->gl_buffer_dirty_ = true;
+}
+
+void Image::upload_gl_buffer() {
+    double upload_start = HighPrecisionTime::now();
+
+    // select buffers of level of detail the current frames were prepared for
+    const float* z_values = this->z_values().data();
+    mpFlow::dtype::index z_value_count = this->z_values().size();
+    const float* element_values = this->element_values().data();
+    mpFlow::dtype::index element_value_count = this->element_values().size();
+    if (this->frames()->level > 0) {
+        z_values = this->frames()->lod_z_values.col(this->frame()).data();
+        z_value_count = this->frames()->lod_z_values.rows();
+        element_values = this->frames()->lod_element_values.col(this->frame()).data();
+        element_value_count = this->frames()->lod_element_values.rows();
+    }
+
+    // upload only one scalar per node and, if needed, one per element
+    this->z_value_buffer().bind();
+    this->z_value_buffer().write(0, z_values, sizeof(float) * z_value_count);
+    this->z_value_buffer().release();
+
+    if (!this->interpolate_colors()) {
+        glBindTexture(GL_TEXTURE_2D, this->element_value_texture_);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, element_value_texture_width,
+            element_value_count / element_value_texture_width, GL_RED, GL_FLOAT,
+            element_values);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    this->gl_buffer_dirty_ = false;
+    this->upload_time() = HighPrecisionTime::now() - upload_start;
+}
+
+void Image::update_lod_level() {
+    if (this->mesh_lod() == nullptr) {
+        return;
+    }
+
+    // the unit radius mesh covers a disc with a diameter of the shorter widget side
+    double radius = 0.5 * std::min(this->width(), this->height());
+    this->lod_level() = this->mesh_lod()->select_level(M_PI * radius * radius);
+    this->render_preparer()->set_level(this->lod_level());
 }
 
 void Image::resizeGL(int w, int h) {
     glViewport(0.5 * w - std::min(w, h), 0.5 * h - std::min(w, h),
         2.0 * std::min(w, h), 2.0 * std::min(w, h));
+
+    this->update_lod_level();
 }
 
 void Image::paintGL() {
+    PROFILE_ZONE("render paint");
+
     // clear
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -221,30 +470,74 @@ void Image::paintGL() {
     glRotatef(this->view_angle()[0], 1.0, 0.0, 0.0);
     glRotatef(this->view_angle()[1], 0.0, 0.0, 1.0);
 
+    // nothing to draw without mesh
+    if (this->elements().rows() == 0) {
+        return;
+    }
+
+    // create and update gpu buffer
+    if (!this->gl_buffer_created_) {
+        this->create_gl_buffer();
+    }
+    if (this->gl_buffer_dirty_) {
+        this->upload_gl_buffer();
+    }
+
+    // bind shader and buffer of level of detail of current frames
+    mpFlow::dtype::index level = this->frames()->level;
+    mpFlow::dtype::index element_count = this->mesh_lod()->levels()[level].elements.rows();
+    this->shader_program()->bind();
+    this->node_buffers()[level].bind();
+    this->shader_program()->setAttributeBuffer("position", GL_FLOAT, 0, 2);
+    this->shader_program()->enableAttributeArray("position");
+    this->z_value_buffer().bind();
+    this->shader_program()->setAttributeBuffer("value", GL_FLOAT, 0, 1);
+    this->shader_program()->enableAttributeArray("value");
+    this->index_buffers()[level].bind();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_1D, this->colormap_texture_);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, this->element_value_texture_);
+    this->shader_program()->setUniformValue("colormap", 0);
+    this->shader_program()->setUniformValue("element_values", 1);
+    this->shader_program()->setUniformValue("element_values_width", (GLint)element_value_texture_width);
+    this->shader_program()->setUniformValue("color_mode", this->interpolate_colors() ? 1 : 0);
+
     // draw mesh
-    glVertexPointer(3, GL_FLOAT, 0, this->vertices().data());
-    glColorPointer(3, GL_FLOAT, 0, this->colors().data());
     glEnable(GL_POLYGON_OFFSET_FILL);
     glPolygonOffset(1.0, 1.0);
-    glDrawArrays(GL_TRIANGLES, 0, this->vertices().cols() * 3);
+    glDrawElements(GL_TRIANGLES, element_count * 3, GL_UNSIGNED_INT, nullptr);
     glDisable(GL_POLYGON_OFFSET_FILL);
 
     // draw wireframes
     if (this->draw_wireframe()) {
-        glColor3f(0.0, 0.0, 0.0);
+        this->shader_program()->setUniformValue("color_mode", 2);
         glLineWidth(1.5);
-        glDisableClientState(GL_COLOR_ARRAY);
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glDrawArrays(GL_TRIANGLES, 0, this->vertices().cols() * 3);
+        glDrawElements(GL_TRIANGLES, element_count * 3, GL_UNSIGNED_INT, nullptr);
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glEnableClientState(GL_COLOR_ARRAY);
     }
 
+    // release shader and buffer
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_1D, 0);
+    this->index_buffers()[level].release();
+    this->shader_program()->disableAttributeArray("value");
+    this->shader_program()->disableAttributeArray("position");
+    this->z_value_buffer().release();
+    this->shader_program()->release();
+
     // draw electrodes
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
     glLineWidth(3.0);
     glVertexPointer(2, GL_FLOAT, 0, this->electrodes().data());
     glColorPointer(3, GL_FLOAT, 0, this->electrode_colors().data());
     glDrawArrays(GL_LINES, 0, this->electrodes().cols() * 2);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 void Image::mousePressEvent(QMouseEvent* event) {
@@ -259,18 +552,42 @@ void Image::mouseMoveEvent(QMouseEvent *event) {
         this->view_angle()[0] += (std::get<1>(this->old_mouse_pos()) - event->y());
         this->old_mouse_pos() = std::make_tuple(event->x(), event->y());
 
-        if (!this->draw_timer().isActive()) {
-            this->updateGL();
-        }
+        this->updateGL();
     }
 }
 
 void Image::wheelEvent(QWheelEvent* event) {
     this->threashold() += event->delta() > 0 ? 0.01 :
             this->threashold() >= 0.01 ? -0.01 : -this->threashold();
+    this->render_preparer()->set_threashold(this->threashold());
+
+    // renormalize current frame into a new single frame batch, buffers of the
+    // presented batch are shared with mirror snapshots and never modified
+    if (this->data().cols() > 0) {
+        auto frames = std::make_shared<RenderFrames>();
+        frames->data = this->data().col(this->frame());
+        if (this->frame() < this->frames()->timestamps.size()) {
+            frames->timestamps = this->frames()->timestamps.segment(this->frame(), 1);
+        }
+        frames->level = this->frames()->level;
+        frames->mesh_generation = this->frames()->mesh_generation;
+        frames->element_values = Eigen::ArrayXXf::Zero(this->frames()->element_values.rows(), 1);
+        frames->z_values = Eigen::ArrayXXf::Zero(this->frames()->z_values.rows(), 1);
+        RenderPreparer::prepare(frames->data, this->node_averaging(), this->sigma_ref(),
+            this->threashold(), frames->element_values, frames->z_values);
+        if (frames->level > 0) {
+            frames->lod_element_values = Eigen::ArrayXXf::Zero(
+                this->frames()->lod_element_values.rows(), 1);
+            frames->lod_z_values = Eigen::ArrayXXf::Zero(this->frames()->lod_z_values.rows(), 1);
+            RenderPreparer::restrict(this->mesh_lod()->levels()[frames->level],
+                frames->element_values, frames->z_values,
+                frames->lod_element_values, frames->lod_z_values);
+        }
+        this->frames() = frames;
+        this->frame() = 0;
 
-    if (!this->draw_timer().isActive()) {
-        this->update_gl_buffer();
+        this->gl_buffer_dirty_ = true;
         this->updateGL();
+        this->publish_frame(HighPrecisionTime::now());
     }
 }
@@ -3,8 +3,17 @@
 
 #include <QGLWidget>
 #include <QtOpenGL>
+#include <QGLBuffer>
+#include <QGLShaderProgram>
 #include <QTimer>
+#include <Eigen/Sparse>
 #include <mpflow/mpflow.h>
+#include "renderpreparer.h"
+#include "framescheduler.h"
+#include "meshlod.h"
+#include "highprecisiontime.h"
+#include "mirrorsnapshot.h"
+#include "latencytracer.h"
 
 class Image : public QGLWidget {
     Q_OBJECT
@@ -14,65 +23,112 @@ public:
 
     void init(std::shared_ptr<mpFlow::EIT::model::Base> model,
         mpFlow::dtype::index rows, mpFlow::dtype::index columns);
+    void init(const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::ArrayXXf& electrodes, mpFlow::dtype::real sigma_ref,
+        mpFlow::dtype::index rows, mpFlow::dtype::index columns);
     void cleanup();
 
+signals:
+    // snapshots for consumers on other threads, e.g. mirror server
+    void mesh_changed(std::shared_ptr<const MirrorMesh> mesh);
+    void frame_presented(std::shared_ptr<const MirrorFrame> frame);
+
 public slots:
     void reset_view();
-    void update_data(Eigen::ArrayXXf data, double time_elapsed);
+    void update_frames(std::shared_ptr<RenderFrames> frames, double time_elapsed);
     void update_gl_buffer();
     void set_draw_wireframe(bool draw_wireframe);
     void set_interpolate_colors(bool interpolate_colors);
 
 protected:
+    void publish_mesh();
+    void publish_frame(double presentation_time);
     virtual void initializeGL();
     virtual void resizeGL(int w, int h);
     virtual void paintGL();
     virtual void mousePressEvent(QMouseEvent* event);
     virtual void mouseMoveEvent(QMouseEvent* event);
     virtual void wheelEvent(QWheelEvent* event);
+    void create_gl_buffer();
+    void upload_gl_buffer();
+    void update_lod_level();
 
 public:
     // accessors
-    Eigen::ArrayXXf& data() { return this->data_; }
-    Eigen::ArrayXXf& vertices() { return this->vertices_; }
-    Eigen::ArrayXXf& colors() { return this->colors_; }
-    Eigen::ArrayXXf& interpolated_colors() { return this->interpolated_colors_; }
+    Eigen::ArrayXXf& data() { return this->frames()->data; }
+    Eigen::ArrayXXf& nodes() { return this->nodes_; }
+    Eigen::ArrayXXf::ColXpr element_values() { return this->frames()->element_values.col(this->frame()); }
     Eigen::ArrayXXf& electrodes() { return this->electrodes_; }
     Eigen::ArrayXXf& electrode_colors() { return this->electrode_colors_; }
     Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements() { return this->elements_; }
-    Eigen::ArrayXf& z_values() { return this->z_values_; }
+    Eigen::ArrayXXf::ColXpr z_values() { return this->frames()->z_values.col(this->frame()); }
     Eigen::ArrayXf& node_area() { return this->node_area_; }
     Eigen::ArrayXf& element_area() { return this->element_area_; }
+    Eigen::SparseMatrix<float, Eigen::RowMajor>& node_averaging() { return this->node_averaging_; }
     std::array<mpFlow::dtype::real, 2>& view_angle() { return this->view_angle_; }
     std::tuple<int, int>& old_mouse_pos() { return this->old_mouse_pos_; }
     mpFlow::dtype::real& threashold() { return this->threashold_; }
     QTimer& draw_timer() { return *this->draw_timer_; }
-    double& image_pos() { return this->image_pos_; }
-    double& image_increment() { return this->image_increment_; }
+    FrameScheduler& frame_scheduler() { return this->frame_scheduler_; }
+    double& vsync_interval() { return this->vsync_interval_; }
+    double& swap_time() { return this->swap_time_; }
+    std::shared_ptr<RenderFrames>& frames() { return this->frames_; }
+    mpFlow::dtype::index& frame() { return this->frame_; }
+    quint64& frame_id() { return this->frame_id_; }
+    quint64& mesh_generation() { return this->mesh_generation_; }
+    RenderPreparer* render_preparer() { return this->render_preparer_; }
+    HighPrecisionTime& frame_time() { return this->frame_time_; }
+    double& gui_frame_time() { return this->gui_frame_time_; }
+    double& upload_time() { return this->upload_time_; }
     mpFlow::dtype::real& sigma_ref() { return this->sigma_ref_; }
     bool draw_wireframe() { return this->draw_wireframe_; }
     bool interpolate_colors() { return this->interpolate_colors_; }
+    QGLShaderProgram* shader_program() { return this->shader_program_; }
+    std::vector<QGLBuffer>& node_buffers() { return this->node_buffers_; }
+    QGLBuffer& z_value_buffer() { return this->z_value_buffer_; }
+    std::vector<QGLBuffer>& index_buffers() { return this->index_buffers_; }
+    std::shared_ptr<MeshLOD>& mesh_lod() { return this->mesh_lod_; }
+    mpFlow::dtype::index& lod_level() { return this->lod_level_; }
+    std::shared_ptr<LatencyTracer>& latency_tracer() { return this->latency_tracer_; }
 
 private:
-    Eigen::ArrayXXf data_;
-    Eigen::ArrayXXf vertices_;
-    Eigen::ArrayXXf colors_;
-    Eigen::ArrayXXf interpolated_colors_;
+    Eigen::ArrayXXf nodes_;
     Eigen::ArrayXXf electrodes_;
     Eigen::ArrayXXf electrode_colors_;
     Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic> elements_;
-    Eigen::ArrayXf z_values_;
     Eigen::ArrayXf node_area_;
     Eigen::ArrayXf element_area_;
+    Eigen::SparseMatrix<float, Eigen::RowMajor> node_averaging_;
     std::array<mpFlow::dtype::real, 2> view_angle_;
     std::tuple<int, int> old_mouse_pos_;
     mpFlow::dtype::real threashold_;
     QTimer* draw_timer_;
-    double image_pos_;
-    double image_increment_;
+    FrameScheduler frame_scheduler_;
+    double vsync_interval_;
+    double swap_time_;
+    std::shared_ptr<RenderFrames> frames_;
+    mpFlow::dtype::index frame_;
+    quint64 frame_id_;
+    quint64 mesh_generation_;
+    RenderPreparer* render_preparer_;
+    HighPrecisionTime frame_time_;
+    double gui_frame_time_;
+    double upload_time_;
     mpFlow::dtype::real sigma_ref_;
     bool draw_wireframe_;
     bool interpolate_colors_;
+    QGLShaderProgram* shader_program_;
+    std::vector<QGLBuffer> node_buffers_;
+    QGLBuffer z_value_buffer_;
+    std::vector<QGLBuffer> index_buffers_;
+    std::shared_ptr<MeshLOD> mesh_lod_;
+    mpFlow::dtype::index lod_level_;
+    std::shared_ptr<LatencyTracer> latency_tracer_;
+    GLuint colormap_texture_;
+    GLuint element_value_texture_;
+    bool gl_buffer_created_;
+    bool gl_buffer_dirty_;
 };
 
 #endif // IMAGE_H
@@ -0,0 +1,165 @@
+#include <QJsonArray>
+#include <algorithm>
+#include "latencytracer.h"
+
+static const size_t sub_bucket_count = 1 << LatencyHistogram::sub_bucket_bits;
+static const size_t half_bucket_count = sub_bucket_count / 2;
+static const quint64 max_value = (1ull << LatencyHistogram::max_magnitude) - 1;
+
+LatencyHistogram::LatencyHistogram() :
+    counts_(sub_bucket_count + (max_magnitude - sub_bucket_bits) * half_bucket_count, 0),
+    count_(0), sum_(0.0), max_(0.0) {
+}
+
+size_t LatencyHistogram::bucket(quint64 value) {
+    if (value < sub_bucket_count) {
+        return value;
+    }
+
+    // octave of value selects bucket range, top bits select bucket within octave
+    int magnitude = sub_bucket_bits;
+    while ((value >> (magnitude + 1)) != 0) {
+        magnitude += 1;
+    }
+    int shift = magnitude - sub_bucket_bits + 1;
+    return sub_bucket_count + (shift - 1) * half_bucket_count + ((value >> shift) - half_bucket_count);
+}
+
+quint64 LatencyHistogram::bucket_value(size_t bucket) {
+    if (bucket < sub_bucket_count) {
+        return bucket;
+    }
+
+    // center of value range covered by bucket
+    int shift = (bucket - sub_bucket_count) / half_bucket_count + 1;
+    quint64 sub_bucket = (bucket - sub_bucket_count) % half_bucket_count + half_bucket_count;
+    return (sub_bucket << shift) + (1ull << (shift - 1));
+}
+
+void LatencyHistogram::record(double latency) {
+    quint64 value = (quint64)std::min(std::max(latency * 1e6, 0.0), (double)max_value);
+    this->counts_[LatencyHistogram::bucket(value)] += 1;
+    this->count_ += 1;
+    this->sum_ += latency;
+    this->max_ = std::max(this->max_, latency);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(this->counts_.begin(), this->counts_.end(), 0);
+    this->count_ = 0;
+    this->sum_ = 0.0;
+    this->max_ = 0.0;
+}
+
+double LatencyHistogram::percentile(double percentile) const {
+    if (this->count() == 0) {
+        return 0.0;
+    }
+
+    // smallest bucket, which covers requested fraction of all recorded latencies
+    quint64 rank = std::max((quint64)1, (quint64)(percentile / 100.0 * this->count() + 0.5));
+    quint64 sum = 0;
+    for (size_t bucket = 0; bucket < this->counts().size(); ++bucket) {
+        sum += this->counts()[bucket];
+        if (sum >= rank) {
+            return std::min((double)LatencyHistogram::bucket_value(bucket) * 1e-6, this->max());
+        }
+    }
+    return this->max();
+}
+
+double LatencyHistogram::mean() const {
+    return this->count() > 0 ? this->sum_ / this->count() : 0.0;
+}
+
+LatencyTracer::LatencyTracer() {
+}
+
+const char* LatencyTracer::stage_name(Stage stage) {
+    static const char* names[] = {
+        "acquisition", "upload", "solve queue", "solve", "host conversion",
+        "render prepare", "queue wait", "paint", "mirror send", "end to end"
+    };
+    return names[stage];
+}
+
+void LatencyTracer::record(const FrameTrace& trace, mpFlow::dtype::index column,
+    double paint_time, double presentation_time) {
+    // each stage spans from previous stamp to its own one, missing stamps,
+    // e.g. of log playback, skip the stage
+    const auto& stamps = trace.stamps;
+    double receive = column < trace.receive.size() ? trace.receive[column] : 0.0;
+    std::array<std::pair<double, double>, stage_count> spans = {{
+        std::make_pair(receive, stamps[FrameTrace::batch_complete]),
+        std::make_pair(stamps[FrameTrace::batch_complete], stamps[FrameTrace::upload]),
+        std::make_pair(stamps[FrameTrace::upload], stamps[FrameTrace::solve_start]),
+        std::make_pair(stamps[FrameTrace::solve_start], stamps[FrameTrace::solve_end]),
+        std::make_pair(stamps[FrameTrace::solve_end], stamps[FrameTrace::host_conversion]),
+        std::make_pair(stamps[FrameTrace::host_conversion], stamps[FrameTrace::render_prepare]),
+        std::make_pair(stamps[FrameTrace::render_prepare], paint_time),
+        std::make_pair(paint_time, presentation_time),
+        std::make_pair(0.0, 0.0),
+        std::make_pair(receive, presentation_time)
+    }};
+
+    QMutexLocker locker(&this->mutex_);
+    for (size_t stage = 0; stage < spans.size(); ++stage) {
+        if ((spans[stage].first > 0.0) && (spans[stage].second > 0.0)) {
+            this->histograms_[stage].record(spans[stage].second - spans[stage].first);
+        }
+    }
+}
+
+void LatencyTracer::record(Stage stage, double latency) {
+    QMutexLocker locker(&this->mutex_);
+
+    this->histograms_[stage].record(latency);
+}
+
+void LatencyTracer::reset() {
+    QMutexLocker locker(&this->mutex_);
+
+    for (auto& histogram : this->histograms_) {
+        histogram.reset();
+    }
+}
+
+LatencyHistogram LatencyTracer::histogram(Stage stage) {
+    QMutexLocker locker(&this->mutex_);
+
+    return this->histograms_[stage];
+}
+
+QJsonObject LatencyTracer::to_json(bool buckets) {
+    // percentiles of all stages in ms, optionally with all non empty buckets for offline analysis
+    QJsonArray stages;
+    for (int stage = 0; stage < stage_count; ++stage) {
+        LatencyHistogram histogram = this->histogram((Stage)stage);
+
+        QJsonObject json;
+        json["stage"] = LatencyTracer::stage_name((Stage)stage);
+        json["count"] = (double)histogram.count();
+        json["mean"] = histogram.mean() * 1e3;
+        json["p50"] = histogram.percentile(50.0) * 1e3;
+        json["p99"] = histogram.percentile(99.0) * 1e3;
+        json["p999"] = histogram.percentile(99.9) * 1e3;
+        json["max"] = histogram.max() * 1e3;
+        if (buckets) {
+            QJsonArray values, counts;
+            for (size_t bucket = 0; bucket < histogram.counts().size(); ++bucket) {
+                if (histogram.counts()[bucket] > 0) {
+                    values.append((double)LatencyHistogram::bucket_value(bucket) * 1e-3);
+                    counts.append((double)histogram.counts()[bucket]);
+                }
+            }
+            json["bucket_values"] = values;
+            json["bucket_counts"] = counts;
+        }
+        stages.append(json);
+    }
+
+    QJsonObject json;
+    json["unit"] = "ms";
+    json["stages"] = stages;
+    return json;
+}
@@ -0,0 +1,100 @@
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <QMutex>
+#include <QJsonObject>
+#include <array>
+#include <vector>
+#include <mpflow/mpflow.h>
+#include "highprecisiontime.h"
+
+// monotonic time stamps of one measurement batch on its way through the
+// pipeline, every stage stamps the batch once, only receive times are kept
+// per frame, frame ids count received datagrams since start
+struct FrameTrace {
+    enum Stage {
+        batch_complete,
+        upload,
+        solve_start,
+        solve_end,
+        host_conversion,
+        render_prepare,
+        stage_count
+    };
+
+    quint64 first_frame_id = 0;
+    std::vector<double> receive;
+    std::array<double, stage_count> stamps = {{}};
+
+    void stamp(Stage stage) { this->stamps[stage] = HighPrecisionTime::now(); }
+};
+
+// log linear histogram of latencies in microseconds in the manner of hdr histograms,
+// first 1024 buckets are linear, each further octave is split into 512 buckets,
+// which keeps relative errors below 0.2 % up to latencies of two minutes
+class LatencyHistogram {
+public:
+    static const int sub_bucket_bits = 10;
+    static const int max_magnitude = 27;
+
+    LatencyHistogram();
+
+    void record(double latency);
+    void reset();
+    double percentile(double percentile) const;
+    double mean() const;
+
+    static size_t bucket(quint64 value);
+    static quint64 bucket_value(size_t bucket);
+
+public:
+    // accessors
+    const std::vector<quint64>& counts() const { return this->counts_; }
+    quint64 count() const { return this->count_; }
+    double max() const { return this->max_; }
+
+private:
+    std::vector<quint64> counts_;
+    quint64 count_;
+    double sum_;
+    double max_;
+};
+
+// per stage latency histograms of all presented frames, filled from the
+// render and mirror threads, read by the live view, the mirror and dumps
+class LatencyTracer {
+public:
+    enum Stage {
+        acquisition,
+        upload,
+        solve_queue,
+        solve,
+        host_conversion,
+        render_prepare,
+        queue_wait,
+        paint,
+        mirror_send,
+        end_to_end,
+        stage_count
+    };
+
+    LatencyTracer();
+
+    static const char* stage_name(Stage stage);
+
+    // records all stages of one frame up to its presentation, the frame waits
+    // for presentation until paint starts, painting includes the buffer swap
+    void record(const FrameTrace& trace, mpFlow::dtype::index column, double paint_time,
+        double presentation_time);
+    void record(Stage stage, double latency);
+    void reset();
+
+    LatencyHistogram histogram(Stage stage);
+    QJsonObject to_json(bool buckets=false);
+
+private:
+    QMutex mutex_;
+    std::array<LatencyHistogram, stage_count> histograms_;
+};
+
+#endif // LATENCYTRACER_H
@@ -0,0 +1,32 @@
+#include <QHeaderView>
+#include "latencyview.h"
+
+LatencyView::LatencyView(QWidget* parent) :
+    QTableWidget(LatencyTracer::stage_count, 6, parent) {
+    this->setHorizontalHeaderLabels(QStringList() << tr("frames") << tr("mean [ms]") <<
+        tr("p50 [ms]") << tr("p99 [ms]") << tr("p99.9 [ms]") << tr("max [ms]"));
+    this->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    this->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    // one row per stage with empty value items, which are updated in place
+    QStringList stages;
+    for (int stage = 0; stage < LatencyTracer::stage_count; ++stage) {
+        stages << LatencyTracer::stage_name((LatencyTracer::Stage)stage);
+        for (int column = 0; column < this->columnCount(); ++column) {
+            this->setItem(stage, column, new QTableWidgetItem(""));
+        }
+    }
+    this->setVerticalHeaderLabels(stages);
+}
+
+void LatencyView::update_view(LatencyTracer& tracer) {
+    for (int stage = 0; stage < LatencyTracer::stage_count; ++stage) {
+        LatencyHistogram histogram = tracer.histogram((LatencyTracer::Stage)stage);
+        this->item(stage, 0)->setText(QString::number(histogram.count()));
+        this->item(stage, 1)->setText(QString::number(histogram.mean() * 1e3, 'f', 2));
+        this->item(stage, 2)->setText(QString::number(histogram.percentile(50.0) * 1e3, 'f', 2));
+        this->item(stage, 3)->setText(QString::number(histogram.percentile(99.0) * 1e3, 'f', 2));
+        this->item(stage, 4)->setText(QString::number(histogram.percentile(99.9) * 1e3, 'f', 2));
+        this->item(stage, 5)->setText(QString::number(histogram.max() * 1e3, 'f', 2));
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef LATENCYVIEW_H
+#define LATENCYVIEW_H
+
+#include <QTableWidget>
+#include "latencytracer.h"
+
+// live table of latency percentiles per pipeline stage
+class LatencyView : public QTableWidget {
+    Q_OBJECT
+public:
+    explicit LatencyView(QWidget* parent=nullptr);
+
+    void update_view(LatencyTracer& tracer);
+};
+
+#endif // LATENCYVIEW_H
@@ -0,0 +1,104 @@
+#ifndef LOGFORMAT_H
+#define LOGFORMAT_H
+
+#include <cstdint>
+
+// layout of self describing recording files:
+//
+//   header | nodes | elements | electrodes | config | block 0 | ... | block n | block index
+//
+// all sections start 8 byte aligned, nodes are stored as interleaved float
+// (x, y) pairs scaled to unit radius, elements as uint32 node triples,
+// electrodes as float (x0, y0, x1, y1) quadruples and config as utf-8 json.
+// Each block holds up to frames_per_block frames in columnar order, first
+// all int64 time stamps in ms, then all frames as float columns of rows
+// values. Each block except the last one is full, so any frame is located
+// in O(1) by its block index entry without parsing any preceding data.
+// Compressed files store each block encoded by FrameCodec instead.
+namespace logformat {
+    // magic bytes and version identifying recording files
+    const char magic[8] = { 'E', 'I', 'T', 'V', 'L', 'O', 'G', 0 };
+    const uint32_t version = 2;
+
+    // encoding of frame blocks
+    enum Compression : uint32_t {
+        none = 0,
+        frame_codec = 1
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t rows;
+        uint32_t frames_per_block;
+        uint32_t node_count;
+        uint32_t element_count;
+        uint32_t electrode_count;
+        uint32_t compression;
+        uint32_t reserved;
+        double sigma_ref;
+        uint64_t nodes_offset;
+        uint64_t elements_offset;
+        uint64_t electrodes_offset;
+        uint64_t config_offset;
+        uint64_t config_size;
+        uint64_t index_offset;
+        uint64_t block_count;
+        uint64_t frame_count;
+    };
+
+    struct BlockIndex {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t first_frame;
+        uint64_t frame_count;
+        int64_t first_timestamp;
+        int64_t last_timestamp;
+    };
+
+    static_assert(sizeof(Header) == 112, "unexpected padding of log header");
+    static_assert(sizeof(BlockIndex) == 48, "unexpected padding of log block index");
+
+    // version 1 files predate compression, their header has no compression
+    // field and their index no block sizes, blocks are always uncompressed
+    namespace v1 {
+        const uint32_t version = 1;
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t rows;
+            uint32_t frames_per_block;
+            uint32_t node_count;
+            uint32_t element_count;
+            uint32_t electrode_count;
+            double sigma_ref;
+            uint64_t nodes_offset;
+            uint64_t elements_offset;
+            uint64_t electrodes_offset;
+            uint64_t config_offset;
+            uint64_t config_size;
+            uint64_t index_offset;
+            uint64_t block_count;
+            uint64_t frame_count;
+        };
+
+        struct BlockIndex {
+            uint64_t offset;
+            uint64_t first_frame;
+            uint64_t frame_count;
+            int64_t first_timestamp;
+            int64_t last_timestamp;
+        };
+
+        static_assert(sizeof(Header) == 104, "unexpected padding of version 1 log header");
+        static_assert(sizeof(BlockIndex) == 40, "unexpected padding of version 1 log block index");
+    }
+
+    // size of a section padded to 8 byte alignment
+    inline uint64_t aligned(uint64_t size) {
+        return (size + 7) & ~(uint64_t)7;
+    }
+}
+
+#endif // LOGFORMAT_H
@@ -0,0 +1,59 @@
+#include "logplayer.h"
+
+LogPlayer::LogPlayer(std::shared_ptr<LogReader> reader, QObject* parent) :
+    QObject(parent), reader_(reader), position_(0), start_timestamp_(0) {
+    // poll recording time often enough for smooth playback
+    this->timer_ = new QTimer(this);
+    this->timer().setTimerType(Qt::PreciseTimer);
+    this->timer().setInterval(10);
+    connect(this->timer_, &QTimer::timeout, this, &LogPlayer::step);
+}
+
+void LogPlayer::set_playing(bool playing) {
+    if (!playing) {
+        this->timer().stop();
+        return;
+    }
+    if (this->reader()->frame_count() == 0) {
+        return;
+    }
+
+    // restart from beginning, if end of recording is reached
+    if (this->position() >= this->reader()->frame_count() - 1) {
+        this->show(0);
+    }
+    this->start_timestamp() = this->reader()->timestamp(this->position());
+    this->playback_time().restart();
+    this->timer().start();
+}
+
+void LogPlayer::seek(int frame) {
+    if ((frame < 0) || ((mpFlow::dtype::index)frame >= this->reader()->frame_count())) {
+        return;
+    }
+
+    // continue playback from new position
+    this->show(frame);
+    this->start_timestamp() = this->reader()->timestamp(frame);
+    this->playback_time().restart();
+}
+
+void LogPlayer::step() {
+    // show last frame recorded until current playback time
+    mpFlow::dtype::index frame = this->reader()->find_frame(this->start_timestamp() +
+        (qint64)(this->playback_time().elapsed() * 1e3));
+    if (frame != this->position()) {
+        this->show(frame);
+    }
+
+    if (frame >= this->reader()->frame_count() - 1) {
+        this->timer().stop();
+    }
+}
+
+void LogPlayer::show(mpFlow::dtype::index frame) {
+    this->position() = frame;
+
+    emit this->data_ready(this->reader()->frames(frame, 1), 0.0, HighPrecisionTime::now(), nullptr);
+    emit this->position_changed(frame);
+}
@@ -0,0 +1,51 @@
+#ifndef LOGPLAYER_H
+#define LOGPLAYER_H
+
+#include <QObject>
+#include <QTimer>
+#include <memory>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+#include "logreader.h"
+#include "highprecisiontime.h"
+#include "latencytracer.h"
+
+// plays back recording files in real time of their time stamps, any
+// frame can be shown instantly by seeking through the block index
+class LogPlayer : public QObject {
+    Q_OBJECT
+public:
+    explicit LogPlayer(std::shared_ptr<LogReader> reader, QObject* parent=nullptr);
+
+signals:
+    void data_ready(Eigen::ArrayXXf data, double time_elapsed, double timestamp,
+        std::shared_ptr<FrameTrace> trace);
+    void position_changed(int frame);
+
+public slots:
+    void set_playing(bool playing);
+    void seek(int frame);
+
+protected slots:
+    void step();
+
+protected:
+    void show(mpFlow::dtype::index frame);
+
+public:
+    // accessors
+    std::shared_ptr<LogReader>& reader() { return this->reader_; }
+    QTimer& timer() { return *this->timer_; }
+    HighPrecisionTime& playback_time() { return this->playback_time_; }
+    mpFlow::dtype::index& position() { return this->position_; }
+    qint64& start_timestamp() { return this->start_timestamp_; }
+
+private:
+    std::shared_ptr<LogReader> reader_;
+    QTimer* timer_;
+    HighPrecisionTime playback_time_;
+    mpFlow::dtype::index position_;
+    qint64 start_timestamp_;
+};
+
+#endif // LOGPLAYER_H
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <QJsonDocument>
+#include <QtConcurrent>
+#include "logreader.h"
+#include "framecodec.h"
+
+LogReader::LogReader(size_t cache_size) :
+    cache_size_(cache_size), memory_(nullptr), header_() {
+}
+
+LogReader::~LogReader() {
+    this->close();
+}
+
+bool LogReader::open(const QString& file_name) {
+    this->close();
+
+    this->file().setFileName(file_name);
+    if (!this->file().open(QIODevice::ReadOnly) ||
+        (this->file().size() < (qint64)sizeof(logformat::v1::Header))) {
+        this->file().close();
+        return false;
+    }
+
+    // map complete file, pages are loaded on demand by the operating system
+    this->memory_ = this->file().map(0, this->file().size());
+    if (this->memory_ == nullptr) {
+        this->file().close();
+        return false;
+    }
+
+    // header and index are copied into current layout, version 1 files
+    // are uncompressed and their block sizes follow from frame counts
+    quint64 size = this->file().size();
+    auto fits = [=](quint64 offset, quint64 length) {
+        return (offset <= size) && (length <= size - offset);
+    };
+    uint32_t version = 0;
+    std::memcpy(&version, this->memory_ + offsetof(logformat::Header, version), sizeof(version));
+    bool valid = std::memcmp(this->memory_, logformat::magic, sizeof(logformat::magic)) == 0;
+    if (valid && (version == logformat::version) && (size >= sizeof(logformat::Header))) {
+        std::memcpy(&this->header_, this->memory_, sizeof(logformat::Header));
+        valid &= fits(this->header().index_offset,
+            (quint64)sizeof(logformat::BlockIndex) * this->header().block_count);
+        if (valid) {
+            this->index_.resize(this->header().block_count);
+            std::memcpy(this->index_.data(), this->memory_ + this->header().index_offset,
+                sizeof(logformat::BlockIndex) * this->index_.size());
+        }
+    } else if (valid && (version == logformat::v1::version)) {
+        logformat::v1::Header header;
+        std::memcpy(&header, this->memory_, sizeof(header));
+        std::memcpy(this->header_.magic, header.magic, sizeof(header.magic));
+        this->header_.version = header.version;
+        this->header_.rows = header.rows;
+        this->header_.frames_per_block = header.frames_per_block;
+        this->header_.node_count = header.node_count;
+        this->header_.element_count = header.element_count;
+        this->header_.electrode_count = header.electrode_count;
+        this->header_.compression = logformat::none;
+        this->header_.sigma_ref = header.sigma_ref;
+        this->header_.nodes_offset = header.nodes_offset;
+        this->header_.elements_offset = header.elements_offset;
+        this->header_.electrodes_offset = header.electrodes_offset;
+        this->header_.config_offset = header.config_offset;
+        this->header_.config_size = header.config_size;
+        this->header_.index_offset = header.index_offset;
+        this->header_.block_count = header.block_count;
+        this->header_.frame_count = header.frame_count;
+        valid &= fits(header.index_offset, (quint64)sizeof(logformat::v1::BlockIndex) * header.block_count);
+        for (quint64 block = 0; valid && (block < header.block_count); ++block) {
+            logformat::v1::BlockIndex entry;
+            std::memcpy(&entry, this->memory_ + header.index_offset + sizeof(entry) * block,
+                sizeof(entry));
+            this->index_.push_back({ entry.offset,
+                (sizeof(qint64) + sizeof(float) * header.rows) * entry.frame_count,
+                entry.first_frame, entry.frame_count, entry.first_timestamp, entry.last_timestamp });
+        }
+    } else {
+        valid = false;
+    }
+
+    // validate header and all sections against file size
+    const auto& header = this->header();
+    valid &= (header.rows > 0) &&
+        ((header.compression == logformat::none) || (header.compression == logformat::frame_codec)) &&
+        (header.frames_per_block > 0) &&
+        fits(header.nodes_offset, (quint64)sizeof(float) * 2 * header.node_count) &&
+        fits(header.elements_offset, (quint64)sizeof(uint32_t) * 3 * header.element_count) &&
+        fits(header.electrodes_offset, (quint64)sizeof(float) * 4 * header.electrode_count) &&
+        fits(header.config_offset, header.config_size);
+    if (valid) {
+        for (mpFlow::dtype::index block = 0; block < this->block_count(); ++block) {
+            valid &= (this->index(block).first_frame == block * header.frames_per_block) &&
+                (this->index(block).frame_count <= header.frames_per_block) &&
+                ((this->index(block).frame_count == header.frames_per_block) ||
+                    (block == this->block_count() - 1)) &&
+                fits(this->index(block).offset, this->index(block).size) &&
+                ((header.compression != logformat::none) || (this->index(block).size ==
+                    (sizeof(qint64) + sizeof(float) * header.rows) * this->index(block).frame_count));
+        }
+        valid &= (this->block_count() == 0) || (header.frame_count ==
+            this->index(this->block_count() - 1).first_frame +
+            this->index(this->block_count() - 1).frame_count);
+    }
+
+    if (!valid) {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void LogReader::close() {
+    if (this->memory_ != nullptr) {
+        this->file().unmap(this->memory_);
+    }
+    this->file().close();
+
+    this->cache().clear();
+    this->memory_ = nullptr;
+    this->header_ = logformat::Header();
+    this->index_.clear();
+}
+
+Eigen::ArrayXf LogReader::frame(mpFlow::dtype::index frame) {
+    if (frame >= this->frame_count()) {
+        return Eigen::ArrayXf();
+    }
+
+    mpFlow::dtype::index block = frame / this->header().frames_per_block;
+    mpFlow::dtype::index column = frame % this->header().frames_per_block;
+
+    std::shared_ptr<const DecodedBlock> decoded;
+    return Eigen::Map<const Eigen::ArrayXf>(this->frame_data(block, &decoded) +
+        column * this->rows(), this->rows());
+}
+
+Eigen::ArrayXXf LogReader::block_frames(mpFlow::dtype::index block) {
+    if (block >= this->block_count()) {
+        return Eigen::ArrayXXf();
+    }
+
+    std::shared_ptr<const DecodedBlock> decoded;
+    return Eigen::Map<const Eigen::ArrayXXf>(this->frame_data(block, &decoded),
+        this->rows(), this->index(block).frame_count);
+}
+
+Eigen::Array<qint64, Eigen::Dynamic, 1> LogReader::block_timestamps(mpFlow::dtype::index block) {
+    if (block >= this->block_count()) {
+        return Eigen::Array<qint64, Eigen::Dynamic, 1>();
+    }
+
+    std::shared_ptr<const DecodedBlock> decoded;
+    return Eigen::Map<const Eigen::Array<qint64, Eigen::Dynamic, 1>>(
+        this->timestamp_data(block, &decoded), this->index(block).frame_count);
+}
+
+const float* LogReader::frame_data(mpFlow::dtype::index block,
+    std::shared_ptr<const DecodedBlock>* decoded) {
+    if (this->compressed()) {
+        *decoded = this->decoded_block(block);
+        return (*decoded)->frames.data();
+    }
+
+    // frames follow time stamps of block
+    const auto& entry = this->index(block);
+    return reinterpret_cast<const float*>(this->memory_ + entry.offset +
+        logformat::aligned(sizeof(qint64) * entry.frame_count));
+}
+
+const qint64* LogReader::timestamp_data(mpFlow::dtype::index block,
+    std::shared_ptr<const DecodedBlock>* decoded) {
+    if (this->compressed()) {
+        *decoded = this->decoded_block(block);
+        return (*decoded)->timestamps.data();
+    }
+
+    return reinterpret_cast<const qint64*>(this->memory_ + this->index(block).offset);
+}
+
+Eigen::ArrayXXf LogReader::frames(mpFlow::dtype::index first, mpFlow::dtype::index count) {
+    count = std::min(count, this->frame_count() - std::min(first, this->frame_count()));
+    Eigen::ArrayXXf frames(this->rows(), count);
+
+    // contiguous parts of all touched blocks
+    struct Part {
+        mpFlow::dtype::index block;
+        mpFlow::dtype::index column;
+        mpFlow::dtype::index frame;
+        mpFlow::dtype::index length;
+    };
+    std::vector<Part> parts;
+    for (mpFlow::dtype::index frame = 0; frame < count; frame += parts.back().length) {
+        mpFlow::dtype::index block = (first + frame) / this->header().frames_per_block;
+        mpFlow::dtype::index column = (first + frame) % this->header().frames_per_block;
+        parts.push_back({ block, column, frame, std::min(count - frame,
+            (mpFlow::dtype::index)this->index(block).frame_count - column) });
+    }
+
+    if (!this->compressed() || (parts.size() == 1)) {
+        for (const auto& part : parts) {
+            std::shared_ptr<const DecodedBlock> decoded;
+            frames.middleCols(part.frame, part.length) = Eigen::Map<const Eigen::ArrayXXf>(
+                this->frame_data(part.block, &decoded) + part.column * this->rows(),
+                this->rows(), part.length);
+        }
+    } else {
+        // decode all touched blocks in parallel without polluting cache
+        QtConcurrent::blockingMap(parts, [&](const Part& part) {
+            Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps(this->index(part.block).frame_count);
+            Eigen::ArrayXXf block_frames(this->rows(), this->index(part.block).frame_count);
+            if (this->decode(part.block, timestamps, block_frames)) {
+                frames.middleCols(part.frame, part.length) =
+                    block_frames.middleCols(part.column, part.length);
+            } else {
+                frames.middleCols(part.frame, part.length).setZero();
+            }
+        });
+    }
+
+    return frames;
+}
+
+qint64 LogReader::timestamp(mpFlow::dtype::index frame) {
+    if (frame >= this->frame_count()) {
+        throw std::out_of_range("LogReader::timestamp: frame out of range");
+    }
+
+    std::shared_ptr<const DecodedBlock> decoded;
+    return this->timestamp_data(frame / this->header().frames_per_block, &decoded)[
+        frame % this->header().frames_per_block];
+}
+
+mpFlow::dtype::index LogReader::find_frame(qint64 timestamp) {
+    if ((this->block_count() == 0) || (timestamp < this->index(0).first_timestamp)) {
+        return 0;
+    }
+
+    // binary search block index first and time stamps of found block second
+    auto block = std::upper_bound(this->index_.begin(), this->index_.end(), timestamp,
+        [](qint64 timestamp, const logformat::BlockIndex& entry) {
+            return timestamp < entry.first_timestamp;
+        }) - 1;
+    std::shared_ptr<const DecodedBlock> decoded;
+    const qint64* timestamps = this->timestamp_data(block - this->index_.begin(), &decoded);
+    mpFlow::dtype::index column = std::upper_bound(timestamps,
+        timestamps + block->frame_count, timestamp) - timestamps - 1;
+
+    return block->first_frame + column;
+}
+
+Eigen::ArrayXXf LogReader::nodes() {
+    return Eigen::Map<const Eigen::ArrayXXf>(reinterpret_cast<const float*>(
+        this->memory_ + this->header().nodes_offset), 2, this->header().node_count);
+}
+
+Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic> LogReader::elements() {
+    return Eigen::Map<const Eigen::Array<uint32_t, Eigen::Dynamic, Eigen::Dynamic>>(
+        reinterpret_cast<const uint32_t*>(this->memory_ + this->header().elements_offset),
+        3, this->header().element_count).transpose().cast<mpFlow::dtype::index>();
+}
+
+Eigen::ArrayXXf LogReader::electrodes() {
+    return Eigen::Map<const Eigen::ArrayXXf>(reinterpret_cast<const float*>(
+        this->memory_ + this->header().electrodes_offset), 4, this->header().electrode_count);
+}
+
+QJsonObject LogReader::config() {
+    return QJsonDocument::fromJson(QByteArray(reinterpret_cast<const char*>(
+        this->memory_ + this->header().config_offset), this->header().config_size)).object();
+}
+
+std::shared_ptr<const LogReader::DecodedBlock> LogReader::decoded_block(mpFlow::dtype::index block) {
+    // most recently used blocks are kept in front of cache, evicted blocks
+    // stay alive as long as a caller still holds them
+    for (auto it = this->cache().begin(); it != this->cache().end(); ++it) {
+        if ((*it)->block == block) {
+            if (it != this->cache().begin()) {
+                auto decoded = *it;
+                this->cache().erase(it);
+                this->cache().push_front(decoded);
+            }
+            return this->cache().front();
+        }
+    }
+
+    // blocks failing to decode are returned zeroed
+    auto decoded = std::make_shared<DecodedBlock>();
+    decoded->block = block;
+    decoded->timestamps.resize(this->index(block).frame_count);
+    decoded->frames.resize(this->rows(), this->index(block).frame_count);
+    if (!this->decode(block, decoded->timestamps, decoded->frames)) {
+        decoded->timestamps.setConstant(this->index(block).first_timestamp);
+        decoded->frames.setZero();
+    }
+
+    this->cache().push_front(decoded);
+    while (this->cache().size() > std::max(this->cache_size_, (size_t)1)) {
+        this->cache().pop_back();
+    }
+
+    return decoded;
+}
+
+bool LogReader::decode(mpFlow::dtype::index block,
+    Eigen::Ref<Eigen::Array<qint64, Eigen::Dynamic, 1>> timestamps,
+    Eigen::Ref<Eigen::ArrayXXf> frames) {
+    // raw data of mapped block is not copied
+    const auto& entry = this->index(block);
+    return FrameCodec::decompress(QByteArray::fromRawData(reinterpret_cast<const char*>(
+        this->memory_ + entry.offset), entry.size), timestamps, frames);
+}
@@ -0,0 +1,83 @@
+#ifndef LOGREADER_H
+#define LOGREADER_H
+
+#include <QFile>
+#include <QJsonObject>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+#include "logformat.h"
+
+// random access to recording files, the complete file is memory mapped and
+// frames are located through the block index without parsing any other data,
+// compressed blocks are decoded on demand and the last ones are kept cached.
+// Files of format version 1 and 2 are read
+class LogReader {
+public:
+    struct DecodedBlock {
+        mpFlow::dtype::index block;
+        Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps;
+        Eigen::ArrayXXf frames;
+    };
+
+    explicit LogReader(size_t cache_size=4);
+    virtual ~LogReader();
+
+    bool open(const QString& file_name);
+    void close();
+    bool is_open() { return this->memory_ != nullptr; }
+
+    // copies of single frames and blocks, they stay valid after the
+    // decoded block was evicted from cache or the file was closed,
+    // indices out of range return empty arrays
+    Eigen::ArrayXf frame(mpFlow::dtype::index frame);
+    Eigen::ArrayXXf block_frames(mpFlow::dtype::index block);
+    Eigen::Array<qint64, Eigen::Dynamic, 1> block_timestamps(mpFlow::dtype::index block);
+
+    // copy of an arbitrary frame range spanning one or more blocks
+    Eigen::ArrayXXf frames(mpFlow::dtype::index first, mpFlow::dtype::index count);
+    // throws std::out_of_range for frames out of range
+    qint64 timestamp(mpFlow::dtype::index frame);
+
+    // index of last frame recorded at or before given time stamp
+    mpFlow::dtype::index find_frame(qint64 timestamp);
+
+    // mesh and config stored in file
+    Eigen::ArrayXXf nodes();
+    Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic> elements();
+    Eigen::ArrayXXf electrodes();
+    QJsonObject config();
+
+protected:
+    // data of block in mapped file or in decoded block, which is kept alive by given pointer
+    const float* frame_data(mpFlow::dtype::index block, std::shared_ptr<const DecodedBlock>* decoded);
+    const qint64* timestamp_data(mpFlow::dtype::index block,
+        std::shared_ptr<const DecodedBlock>* decoded);
+    std::shared_ptr<const DecodedBlock> decoded_block(mpFlow::dtype::index block);
+    bool decode(mpFlow::dtype::index block,
+        Eigen::Ref<Eigen::Array<qint64, Eigen::Dynamic, 1>> timestamps,
+        Eigen::Ref<Eigen::ArrayXXf> frames);
+
+public:
+    // accessors
+    QFile& file() { return this->file_; }
+    const logformat::Header& header() { return this->header_; }
+    const logformat::BlockIndex& index(mpFlow::dtype::index block) { return this->index_[block]; }
+    mpFlow::dtype::index rows() { return this->header().rows; }
+    mpFlow::dtype::index frame_count() { return this->header().frame_count; }
+    mpFlow::dtype::index block_count() { return this->header().block_count; }
+    bool compressed() { return this->header().compression != logformat::none; }
+    std::deque<std::shared_ptr<const DecodedBlock>>& cache() { return this->cache_; }
+
+private:
+    size_t cache_size_;
+    std::deque<std::shared_ptr<const DecodedBlock>> cache_;
+    QFile file_;
+    uchar* memory_;
+    logformat::Header header_;
+    std::vector<logformat::BlockIndex> index_;
+};
+
+#endif // LOGREADER_H
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstring>
+#include <QtConcurrent>
+#include <QThread>
+#include "logwriter.h"
+#include "framecodec.h"
+
+LogWriter::LogWriter(size_t block_size, logformat::Compression compression) :
+    block_size_(block_size), compression_(compression), block_fill_(0) {
+    std::memset(&this->header(), 0, sizeof(logformat::Header));
+}
+
+LogWriter::~LogWriter() {
+    this->close();
+}
+
+bool LogWriter::open(const QString& file_name, mpFlow::dtype::index rows,
+    mpFlow::dtype::real sigma_ref, const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::ArrayXXf& electrodes, const QByteArray& config) {
+    this->close();
+
+    this->file().setFileName(file_name);
+    if (!this->file().open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    // fill header, blocks hold as many frames as fit into block size
+    std::memset(&this->header(), 0, sizeof(logformat::Header));
+    std::memcpy(this->header().magic, logformat::magic, sizeof(logformat::magic));
+    this->header().version = logformat::version;
+    this->header().rows = rows;
+    this->header().frames_per_block = std::max((size_t)1,
+        this->block_size_ / (sizeof(qint64) + sizeof(float) * rows));
+    this->header().node_count = nodes.cols();
+    this->header().element_count = elements.rows();
+    this->header().electrode_count = electrodes.cols();
+    this->header().compression = this->compression();
+    this->header().sigma_ref = sigma_ref;
+
+    // header is rewritten with final offsets on close
+    bool success = this->write_section(&this->header(), sizeof(logformat::Header));
+
+    // mesh and config sections
+    this->header().nodes_offset = this->file().pos();
+    success &= this->write_section(nodes.data(), sizeof(float) * nodes.size());
+
+    Eigen::Array<uint32_t, Eigen::Dynamic, Eigen::Dynamic> element_nodes =
+        elements.transpose().cast<uint32_t>();
+    this->header().elements_offset = this->file().pos();
+    success &= this->write_section(element_nodes.data(), sizeof(uint32_t) * element_nodes.size());
+
+    this->header().electrodes_offset = this->file().pos();
+    success &= this->write_section(electrodes.data(), sizeof(float) * electrodes.size());
+
+    this->header().config_offset = this->file().pos();
+    this->header().config_size = config.size();
+    success &= this->write_section(config.constData(), config.size());
+
+    // allocate block buffer
+    this->index().clear();
+    this->pending().clear();
+    this->block_timestamps() = Eigen::Array<qint64, Eigen::Dynamic, 1>(this->header().frames_per_block);
+    this->block_frames() = Eigen::ArrayXXf(rows, this->header().frames_per_block);
+    this->block_fill() = 0;
+
+    if (!success) {
+        this->file().close();
+    }
+    return success;
+}
+
+bool LogWriter::write(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+    const Eigen::Ref<const Eigen::ArrayXXf>& frames) {
+    if (!this->file().isOpen() || (frames.rows() != this->header().rows) ||
+        (frames.cols() != timestamps.rows())) {
+        return false;
+    }
+
+    // copy frames to block buffer and write each full block
+    bool success = true;
+    mpFlow::dtype::index frame = 0;
+    while (frame < frames.cols()) {
+        mpFlow::dtype::index count = std::min((mpFlow::dtype::index)frames.cols() - frame,
+            (mpFlow::dtype::index)this->block_frames().cols() - this->block_fill());
+        this->block_timestamps().segment(this->block_fill(), count) = timestamps.segment(frame, count);
+        this->block_frames().middleCols(this->block_fill(), count) = frames.middleCols(frame, count);
+        this->block_fill() += count;
+        frame += count;
+
+        if (this->block_fill() == this->block_frames().cols()) {
+            success &= this->flush_block();
+        }
+    }
+
+    return success;
+}
+
+bool LogWriter::close() {
+    if (!this->file().isOpen()) {
+        return false;
+    }
+
+    // write last partial block and index
+    bool success = this->flush_block();
+    success &= this->write_pending();
+    this->header().index_offset = this->file().pos();
+    this->header().block_count = this->index().size();
+    success &= this->write_section(this->index().data(),
+        sizeof(logformat::BlockIndex) * this->index().size());
+
+    // rewrite header with final offsets
+    success &= this->file().seek(0);
+    success &= this->file().write((const char*)&this->header(), sizeof(logformat::Header)) ==
+        sizeof(logformat::Header);
+    this->file().close();
+
+    // release block buffer
+    this->block_timestamps() = Eigen::Array<qint64, Eigen::Dynamic, 1>();
+    this->block_frames() = Eigen::ArrayXXf();
+
+    return success;
+}
+
+bool LogWriter::write_section(const void* data, qint64 size) {
+    static const char padding[8] = { 0 };
+
+    bool success = this->file().write((const char*)data, size) == size;
+    qint64 padding_size = logformat::aligned(size) - size;
+    if (padding_size > 0) {
+        success &= this->file().write(padding, padding_size) == padding_size;
+    }
+
+    return success;
+}
+
+bool LogWriter::flush_block() {
+    if (this->block_fill() == 0) {
+        return true;
+    }
+
+    bool success = true;
+    if (this->compression() == logformat::none) {
+        success = this->write_block(this->block_timestamps().head(this->block_fill()),
+            this->block_frames().leftCols(this->block_fill()), QByteArray());
+    } else {
+        // collect blocks to compress one block per thread at once
+        Block block;
+        block.timestamps = this->block_timestamps().head(this->block_fill());
+        block.frames = this->block_frames().leftCols(this->block_fill());
+        this->pending().push_back(block);
+
+        if (this->pending().size() >= (size_t)std::max(1, QThread::idealThreadCount())) {
+            success = this->write_pending();
+        }
+    }
+    this->block_fill() = 0;
+
+    return success;
+}
+
+bool LogWriter::write_pending() {
+    // compress in parallel, but keep order of blocks in file
+    QtConcurrent::blockingMap(this->pending(), [](Block& block) {
+        block.data = FrameCodec::compress(block.timestamps, block.frames);
+    });
+
+    bool success = true;
+    for (const auto& block : this->pending()) {
+        success &= this->write_block(block.timestamps, block.frames, block.data);
+    }
+    this->pending().clear();
+
+    return success;
+}
+
+bool LogWriter::write_block(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+    const Eigen::Ref<const Eigen::ArrayXXf>& frames, const QByteArray& data) {
+    // add block to index
+    logformat::BlockIndex entry;
+    entry.offset = this->file().pos();
+    entry.first_frame = this->header().frame_count;
+    entry.frame_count = frames.cols();
+    entry.first_timestamp = timestamps(0);
+    entry.last_timestamp = timestamps(timestamps.size() - 1);
+
+    // columnar layout, time stamps first, frames second, or encoded block
+    bool success = true;
+    if (this->compression() == logformat::none) {
+        entry.size = sizeof(qint64) * frames.cols() + sizeof(float) * frames.size();
+        success &= this->write_section(timestamps.data(), sizeof(qint64) * timestamps.size());
+        success &= this->write_section(frames.data(), sizeof(float) * frames.size());
+    } else {
+        entry.size = data.size();
+        success &= this->write_section(data.constData(), data.size());
+    }
+    this->index().push_back(entry);
+    this->header().frame_count += frames.cols();
+
+    return success;
+}
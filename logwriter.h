@@ -0,0 +1,63 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QFile>
+#include <QByteArray>
+#include <vector>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+#include "logformat.h"
+
+// writes recording files block by block, memory use is bounded by one block,
+// or by one block per thread, if blocks are compressed in parallel
+class LogWriter {
+public:
+    struct Block {
+        Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps;
+        Eigen::ArrayXXf frames;
+        QByteArray data;
+    };
+
+    explicit LogWriter(size_t block_size=4 * 1024 * 1024,
+        logformat::Compression compression=logformat::none);
+    virtual ~LogWriter();
+
+    bool open(const QString& file_name, mpFlow::dtype::index rows, mpFlow::dtype::real sigma_ref,
+        const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::ArrayXXf& electrodes, const QByteArray& config);
+    bool write(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+        const Eigen::Ref<const Eigen::ArrayXXf>& frames);
+    bool close();
+
+protected:
+    bool write_section(const void* data, qint64 size);
+    bool flush_block();
+    bool write_pending();
+    bool write_block(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+        const Eigen::Ref<const Eigen::ArrayXXf>& frames, const QByteArray& data);
+
+public:
+    // accessors
+    QFile& file() { return this->file_; }
+    logformat::Header& header() { return this->header_; }
+    std::vector<logformat::BlockIndex>& index() { return this->index_; }
+    std::vector<Block>& pending() { return this->pending_; }
+    logformat::Compression compression() { return this->compression_; }
+    Eigen::Array<qint64, Eigen::Dynamic, 1>& block_timestamps() { return this->block_timestamps_; }
+    Eigen::ArrayXXf& block_frames() { return this->block_frames_; }
+    mpFlow::dtype::index& block_fill() { return this->block_fill_; }
+
+private:
+    size_t block_size_;
+    logformat::Compression compression_;
+    QFile file_;
+    logformat::Header header_;
+    std::vector<logformat::BlockIndex> index_;
+    std::vector<Block> pending_;
+    Eigen::Array<qint64, Eigen::Dynamic, 1> block_timestamps_;
+    Eigen::ArrayXXf block_frames_;
+    mpFlow::dtype::index block_fill_;
+};
+
+#endif // LOGWRITER_H
@@ -1,8 +1,10 @@
 #include <QApplication>
+#include <QThread>
 #include "mainwindow.h"
 
 int main(int argc, char *argv[]) {
     QApplication a(argc, argv);
+    QThread::currentThread()->setObjectName("gui");
     MainWindow w;
     w.show();
     
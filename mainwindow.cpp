@@ -1,23 +1,35 @@
 #include <fstream>
+#include <limits>
+#include <stdexcept>
 #include <mpflow/mpflow.h>
 #include <QtCore>
 #include <QtGui>
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QJsonDocument>
+#include <QtConcurrent>
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "image.h"
 #include "measurementsystem.h"
 #include "calibratordialog.h"
+#include "offscreenrenderer.h"
+#include "frameexporter.h"
+#include "textexporter.h"
+#include "logreader.h"
+#include "profiler.h"
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent), ui(new Ui::MainWindow), measurement_system_(nullptr),
-    solver_(nullptr), calibrator_(nullptr), datalogger_(nullptr), open_file_name_("") {
+    solver_(nullptr), calibrator_(nullptr), datalogger_(nullptr), _mirrorserver(nullptr),
+    analysis_engine_(nullptr), statistics_(), region_plot_(nullptr), latency_tracer_(nullptr),
+    latency_view_(nullptr), log_player_(nullptr),
+    open_file_name_("") {
     // enable multisampling antialiasing for image whole application
     QGLFormat gl_format;
     gl_format.setSampleBuffers(true);
     gl_format.setSamples(16);
+    gl_format.setSwapInterval(1);
     QGLFormat::setDefaultFormat(gl_format);
 
     // setup ui
@@ -30,6 +42,78 @@ MainWindow::MainWindow(QWidget *parent) :
     // create data logger
     this->datalogger_ = new DataLogger();
     connect(this->ui->actionReset_DataLogger, &QAction::triggered, this->datalogger(), &DataLogger::reset_log);
+    connect(this->ui->actionLog_Raw_Measurements, &QAction::toggled, this->datalogger(),
+        &DataLogger::set_log_measurements);
+
+    // tap raw measurements directly in measurement system thread
+    connect(this->measurement_system(), &MeasurementSystem::datagram_received, this->datalogger(),
+        &DataLogger::add_measurement, Qt::DirectConnection);
+
+    // create mirror server, which runs in its own thread and only sees snapshots
+    qRegisterMetaType<std::shared_ptr<const MirrorMesh>>("std::shared_ptr<const MirrorMesh>");
+    qRegisterMetaType<std::shared_ptr<const MirrorFrame>>("std::shared_ptr<const MirrorFrame>");
+    this->_mirrorserver = new MirrorServer();
+    connect(this->ui->image, &Image::mesh_changed, this->mirrorserver(), &MirrorServer::update_mesh);
+    connect(this->ui->image, &Image::frame_presented, this->mirrorserver(), &MirrorServer::publish_frame);
+    connect(this->ui->image->render_preparer(), &RenderPreparer::frames_ready, this->mirrorserver(),
+        &MirrorServer::update_history);
+    connect(this, &MainWindow::analysis_updated, this->mirrorserver(), &MirrorServer::update_analysis);
+    connect(this, &MainWindow::images_exported, this, &MainWindow::export_images_finished,
+        Qt::QueuedConnection);
+    connect(this->mirrorserver(), &MirrorServer::calibrate, this, &MainWindow::on_actionCalibrate_triggered);
+
+    // analyse all prepared frames in separate thread, table only shows latest results
+    this->analysis_engine_ = new AnalysisEngine();
+    connect(this->ui->image->render_preparer(), &RenderPreparer::frames_ready,
+        this->analysis_engine(), &AnalysisEngine::update_frames);
+
+    // plot, log and mirror regional mean values of every frame
+    qRegisterMetaType<std::shared_ptr<const RegionSamples>>("std::shared_ptr<const RegionSamples>");
+    this->region_plot_ = new RegionPlot();
+    QDockWidget* region_dock = new QDockWidget(tr("Regions"), this);
+    region_dock->setWidget(this->region_plot());
+    this->addDockWidget(Qt::BottomDockWidgetArea, region_dock);
+    region_dock->hide();
+    this->ui->menuImage->addAction(region_dock->toggleViewAction());
+    connect(this->analysis_engine(), &AnalysisEngine::regions_ready, this->region_plot(),
+        &RegionPlot::add_samples);
+    connect(this->analysis_engine(), &AnalysisEngine::regions_ready, this->mirrorserver(),
+        &MirrorServer::update_regions);
+    connect(this->analysis_engine(), &AnalysisEngine::regions_ready, this->datalogger(),
+        &DataLogger::add_regions, Qt::DirectConnection);
+
+    // trace every frame from datagram receive to presentation and mirror send
+    qRegisterMetaType<std::shared_ptr<FrameTrace>>("std::shared_ptr<FrameTrace>");
+    this->latency_tracer() = std::make_shared<LatencyTracer>();
+    this->ui->image->latency_tracer() = this->latency_tracer();
+    this->mirrorserver()->latency_tracer() = this->latency_tracer();
+    this->latency_view_ = new LatencyView();
+    QDockWidget* latency_dock = new QDockWidget(tr("Latency"), this);
+    latency_dock->setWidget(this->latency_view());
+    this->addDockWidget(Qt::BottomDockWidgetArea, latency_dock);
+    latency_dock->hide();
+    this->ui->menuImage->addAction(latency_dock->toggleViewAction());
+    connect(this->ui->menuInfo->addAction(tr("Save Latency Histograms...")), &QAction::triggered,
+        this, &MainWindow::save_latency_histograms);
+    connect(this->ui->menuInfo->addAction(tr("Reset Latency Histograms")), &QAction::triggered,
+        [=]() { this->latency_tracer()->reset(); });
+
+    // profiler zones are recorded while the profiler is enabled, which it is by
+    // default, a trace of the buffered zones is only created on demand
+    QAction* profiler_action = this->ui->menuInfo->addAction(tr("Enable Profiler"));
+    profiler_action->setCheckable(true);
+    profiler_action->setChecked(Profiler::enabled());
+    connect(profiler_action, &QAction::toggled, [](bool enabled) { Profiler::set_enabled(enabled); });
+    connect(this->ui->menuInfo->addAction(tr("Save Profile Trace...")), &QAction::triggered,
+        this, &MainWindow::save_profile_trace);
+
+    // create playback controls for recorded logs
+    this->playback_toolbar_ = this->addToolBar(tr("Playback"));
+    this->play_action_ = this->playback_toolbar()->addAction(tr("Play"));
+    this->play_action()->setCheckable(true);
+    this->playback_slider_ = new QSlider(Qt::Horizontal, this->playback_toolbar());
+    this->playback_toolbar()->addWidget(this->playback_slider());
+    this->update_playback_menu_items(false);
 
     // TODO
     // init table widget
@@ -58,46 +142,105 @@ MainWindow::~MainWindow() {
         delete this->measurement_system();
     }
 
+    // stop analysis engine
+    this->analysis_engine()->thread()->quit();
+    this->analysis_engine()->thread()->wait();
+    delete this->analysis_engine();
+
+    // stop mirror server
+    this->mirrorserver()->thread()->quit();
+    this->mirrorserver()->thread()->wait();
+    delete this->mirrorserver();
+
+    // wait for image export still reading data log, then flush and close it
+    this->export_future().waitForFinished();
+    delete this->datalogger();
+
     delete this->ui;
 }
 
 void MainWindow::initTable() {
     this->addAnalysis("system fps:", "", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
-        return 1e3 / (20.0 / this->ui->image->image_increment());
+        return this->ui->image->frame_scheduler().frame_rate();
     });
     this->addAnalysis("latency:", "ms", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
-        return 20.0 / this->ui->image->image_increment() * this->solver()->eit_solver()->measurement().size() + this->solver()->solve_time() * 1e3;
+        // median of traced frames from datagram receive, playback has no traces
+        LatencyHistogram histogram = this->latency_tracer()->histogram(LatencyTracer::end_to_end);
+        return histogram.count() > 0 ? histogram.percentile(50.0) * 1e3 :
+            this->ui->image->frame_scheduler().latency() * 1e3;
+    });
+    double ingest_time = HighPrecisionTime::now(), ingest_rate = 0.0;
+    unsigned long long ingest_datagrams = 0;
+    this->addAnalysis("ingest rate:", "1/s", [=](const Eigen::Ref<Eigen::ArrayXf>&) mutable {
+        // valid datagrams per second averaged over at least one second
+        double now = HighPrecisionTime::now();
+        if (now - ingest_time >= 1.0) {
+            unsigned long long datagrams = this->measurement_system()->received_datagrams() -
+                this->measurement_system()->malformed_datagrams();
+            ingest_rate = (datagrams - ingest_datagrams) / (now - ingest_time);
+            ingest_datagrams = datagrams;
+            ingest_time = now;
+        }
+        return ingest_rate;
+    });
+    double bandwidth_time = HighPrecisionTime::now(), bandwidth = 0.0;
+    unsigned long long bandwidth_bytes = 0;
+    this->addAnalysis("ingest bandwidth:", "MB/s", [=](const Eigen::Ref<Eigen::ArrayXf>&) mutable {
+        // all received bytes, including malformed datagrams
+        double now = HighPrecisionTime::now();
+        if (now - bandwidth_time >= 1.0) {
+            unsigned long long bytes = this->measurement_system()->received_bytes();
+            bandwidth = (bytes - bandwidth_bytes) * 1e-6 / (now - bandwidth_time);
+            bandwidth_bytes = bytes;
+            bandwidth_time = now;
+        }
+        return bandwidth;
+    });
+    this->addAnalysis("malformed datagrams:", "", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
+        return this->measurement_system()->malformed_datagrams().load();
+    });
+    this->addAnalysis("max pending datagrams:", "", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
+        return this->measurement_system()->max_pending_datagrams().load();
+    });
+    this->addAnalysis("completed batches:", "", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
+        return this->measurement_system()->completed_batches().load();
+    });
+    this->addAnalysis("dropped frames:", "", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
+        return this->ui->image->frame_scheduler().dropped_frames();
     });
     this->addAnalysis("solve time:", "ms", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
-        return this->solver()->solve_time() * 1e3;
+        return this->solver() ? this->solver()->solve_time() * 1e3 : 0.0;
+    });
+    this->addAnalysis("render prepare time:", "ms", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
+        return this->ui->image->render_preparer()->prepare_time() * 1e3;
+    });
+    this->addAnalysis("gui frame time:", "ms", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
+        return this->ui->image->gui_frame_time() * 1e3;
+    });
+    this->addAnalysis("analysis time:", "ms", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
+        return this->analysis_engine()->analyse_time() * 1e3;
     });
     if (this->hasMultiGPU()) {
         this->addAnalysis("calibrate time:", "ms", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
-            return this->calibrator()->solve_time() * 1e3;
+            return this->calibrator() ? this->calibrator()->solve_time() * 1e3 : 0.0;
         });
     }
     this->addAnalysis("normalization threashold:", "%", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
         return this->ui->image->threashold() * 100.0;
     });
     this->addAnalysis("mesh elements:", "", [=](const Eigen::Ref<Eigen::ArrayXf>&) {
-        return this->solver()->eit_solver()->forward_solver()->model()->mesh()->elements()->rows();
-    });
-    this->addAnalysis("min:", "mS", [=](const Eigen::Ref<Eigen::ArrayXf>& values) {
-        return values.minCoeff() * 1e3;
-    });
-    this->addAnalysis("max:", "mS", [=](const Eigen::Ref<Eigen::ArrayXf>& values) {
-        return values.maxCoeff() * 1e3;
-    });
-    this->addAnalysis("mean value:", "mS", [=](const Eigen::Ref<Eigen::ArrayXf>& values) -> mpFlow::dtype::real {
-        return (values * this->ui->image->element_area()).sum() /
-            this->ui->image->element_area().sum() * 1e3;
-    });
-    this->addAnalysis("standard deviation:", "mS", [=](const Eigen::Ref<Eigen::ArrayXf>& values) -> mpFlow::dtype::real {
-        mpFlow::dtype::real mean = (values * this->ui->image->element_area()).sum() /
-            this->ui->image->element_area().sum();
-        return std::sqrt(((values - mean).square() * this->ui->image->element_area()).sum() /
-            this->ui->image->element_area().sum()) * 1e3;
+        return this->ui->image->elements().rows();
     });
+
+    // one row per kernel of statistics pipeline
+    auto names = StatisticsPipeline::names();
+    auto units = StatisticsPipeline::units();
+    for (size_t kernel = 0; kernel < StatisticsPipeline::size; ++kernel) {
+        this->addAnalysis(QString(names[kernel]) + ":", units[kernel],
+            [=](const Eigen::Ref<Eigen::ArrayXf>&) {
+            return this->statistics()[kernel];
+        });
+    }
 }
 
 void MainWindow::addAnalysis(QString name, QString unit,
@@ -116,15 +259,34 @@ void MainWindow::addAnalysis(QString name, QString unit,
 }
 
 void MainWindow::analyse() {
-    // evaluate analysis functions
+    // statistics of displayed frame were already computed by analysis engine,
+    // they are left empty rather than showing those of another frame
+    if (!this->analysis_engine()->statistics(*this->ui->image->frames(),
+        this->ui->image->frame(), &this->statistics())) {
+        this->statistics().fill(std::numeric_limits<float>::quiet_NaN());
+    }
+
+    // evaluate analysis functions once for table and mirror
     for (const auto& analysisFunction : this->analysisFunctions()) {
+        QString result = QString("%1 ").arg(std::get<2>(analysisFunction)(this->ui->image->data()
+            .col(this->ui->image->frame()))) + std::get<1>(analysisFunction);
         this->analysis()[std::get<0>(analysisFunction)] = std::make_tuple(
-            std::get<0>(this->analysis()[std::get<0>(analysisFunction)]),
-            QString("%1 ").arg(std::get<2>(analysisFunction)(this->ui->image->data()
-                .col(this->ui->image->image_pos()))) + std::get<1>(analysisFunction));
-        this->ui->analysis_table->item(std::get<0>(analysisFunction), 1)->setText(
-            QString("%1 ").arg(std::get<2>(analysisFunction)(this->ui->image->data()
-                .col(this->ui->image->image_pos()))) + std::get<1>(analysisFunction));
+            std::get<0>(this->analysis()[std::get<0>(analysisFunction)]), result);
+        this->ui->analysis_table->item(std::get<0>(analysisFunction), 1)->setText(result);
+    }
+
+    // publish copy of results to mirror server thread
+    QVariantList snapshot;
+    for (const auto& analysis : this->analysis()) {
+        QVariantMap analysisMap;
+        analysisMap["name"] = std::get<0>(analysis);
+        analysisMap["result"] = std::get<1>(analysis);
+        snapshot.append(analysisMap);
+    }
+    emit this->analysis_updated(snapshot);
+
+    if (this->latency_view()->isVisible()) {
+        this->latency_view()->update_view(*this->latency_tracer());
     }
 }
 
@@ -152,6 +314,7 @@ void MainWindow::on_actionOpen_triggered() {
         auto json_document = QJsonDocument::fromJson(str.toUtf8());
         auto config = json_document.object();
         file.close();
+        this->config() = config;
 
         // create same mesh for both solver and calibrator
         auto mesh = Solver::createMeshFromConfig(
@@ -179,6 +342,64 @@ void MainWindow::on_actionOpen_triggered() {
     }
 }
 
+void MainWindow::on_actionOpen_Log_triggered() {
+    // get open file name
+    QString file_name = QFileDialog::getOpenFileName(
+        this, "Open Log", this->open_file_name(), "Log File (*.log)");
+
+    if (file_name != "") {
+        // close current solver or playback
+        this->close_solver();
+
+        // map recording file, raw measurement and region logs carry no mesh to display
+        auto reader = std::make_shared<LogReader>();
+        if (!reader->open(file_name)) {
+            QMessageBox::information(this, this->windowTitle(),
+                tr("Cannot open log!"));
+            return;
+        }
+        if (reader->header().element_count == 0) {
+            QMessageBox::information(this, this->windowTitle(),
+                tr("Log holds raw measurements or regional mean values without a mesh "
+                    "and cannot be played back, open the image log saved next to it instead!"));
+            return;
+        }
+
+        // update window title
+        this->setWindowTitle(tr("eitViewer") + " - " + file_name);
+
+        // init image with recorded mesh
+        this->ui->image->init(reader->nodes(), reader->elements(), reader->electrodes(),
+            reader->header().sigma_ref, reader->rows(), 1);
+        this->analysis_engine()->init(this->ui->image->element_area(), this->ui->image->sigma_ref(),
+            this->ui->image->mesh_generation(), std::make_shared<RegionsOfInterest>(this->ui->image->nodes(), this->ui->image->elements(),
+                this->ui->image->element_area()));
+        this->region_plot()->clear();
+        this->config() = reader->config();
+        qRegisterMetaType<Eigen::ArrayXXf>("Eigen::ArrayXXf");
+        qRegisterMetaType<std::shared_ptr<RenderFrames>>("std::shared_ptr<RenderFrames>");
+
+        // create player, slider only seeks on user interaction
+        this->log_player_ = new LogPlayer(reader, this);
+        connect(this->log_player(), &LogPlayer::data_ready, this->ui->image->render_preparer(),
+            &RenderPreparer::update_data);
+        connect(this->log_player(), &LogPlayer::position_changed, this->playback_slider(),
+            &QSlider::setValue);
+        connect(this->playback_slider(), &QSlider::sliderMoved, this->log_player(),
+            &LogPlayer::seek);
+        connect(this->play_action(), &QAction::toggled, this->log_player(),
+            &LogPlayer::set_playing);
+        this->playback_slider()->setRange(0, std::max((int)reader->frame_count() - 1, 0));
+        this->update_playback_menu_items(true);
+
+        // show first frame
+        this->log_player()->seek(0);
+        this->analysis_timer_->start(20);
+
+        // save current file name
+        this->open_file_name() = file_name;
+    }
+}
 
 void MainWindow::on_actionExit_triggered() {
     // quit application
@@ -274,23 +495,124 @@ void MainWindow::on_actionSave_DataLogger_triggered() {
     QString file_name = QFileDialog::getSaveFileName(
         this, "Save Log", "", "Log File (*.log)");
 
-    // save mesh adn data log
+    // save data log together with mesh and config
     if (file_name != "") {
-        // save nodes and elements
-        mpFlow::numeric::matrix::savetxt((file_name + ".nodes").toStdString(),
-            this->solver()->eit_solver()->forward_solver()->model()->mesh()->nodes());
-        mpFlow::numeric::matrix::savetxt((file_name + ".elements").toStdString(),
-            this->solver()->eit_solver()->forward_solver()->model()->mesh()->elements());
-
-        // save log
-        std::ofstream file;
-        file.open(file_name.toStdString().c_str());
-        if (file.fail()) {
+        if (!this->datalogger()->save(file_name, this->ui->image->sigma_ref(),
+            this->ui->image->nodes(), this->ui->image->elements(), this->ui->image->electrodes(),
+            QJsonDocument(this->config()).toJson(QJsonDocument::Compact))) {
             QMessageBox::information(this, this->windowTitle(),
                 tr("Cannot save log!"));
         }
+    }
+}
+
+void MainWindow::on_actionExport_Images_triggered() {
+    // get export file name
+    QString file_name = QFileDialog::getSaveFileName(
+        this, "Export Images", "", "PNG Sequence (*.png);;Raw RGB24 Video (*.rgb)");
+
+    if (file_name != "") {
+        // raw video file is opened before export starts to report errors directly
+        auto file = std::make_shared<QFile>(file_name);
+        if (file_name.endsWith(".rgb") && !file->open(QIODevice::WriteOnly)) {
+            QMessageBox::information(this, this->windowTitle(),
+                tr("Cannot open %1 for writing!").arg(file_name));
+            return;
+        }
+        QString base_name = file_name.endsWith(".png") ?
+            file_name.left(file_name.length() - QString(".png").length()) : file_name;
+
+        // render with same settings as current view
+        auto renderer = std::make_shared<OffscreenRenderer>(this->ui->image->nodes(),
+            this->ui->image->elements(), this->ui->image->node_averaging(),
+            this->ui->image->electrodes(), this->ui->image->electrode_colors(),
+            this->ui->image->sigma_ref());
+        renderer->view_angle() = this->ui->image->view_angle();
+        renderer->threashold() = this->ui->image->threashold();
+        renderer->draw_wireframe() = this->ui->image->draw_wireframe();
+        renderer->interpolate_colors() = this->ui->image->interpolate_colors();
+        int size = std::min(this->ui->image->width(), this->ui->image->height());
+
+        // export runs in background, so live view keeps running, logged frames
+        // are read back block wise, so memory use does not grow with log length
+        this->ui->actionExport_Images->setEnabled(false);
+        this->export_future() = QtConcurrent::run([=]() {
+            FrameExporter exporter(renderer.get(), size);
+            const qint64 block_size = 256;
+            qint64 frame_count = this->datalogger()->frame_count();
+            bool success = true;
+            HighPrecisionTime time;
+            try {
+                for (qint64 first = 0; first < frame_count; first += block_size) {
+                    Eigen::ArrayXXf frames = this->datalogger()->frames(first, block_size);
+                    if (file_name.endsWith(".rgb")) {
+                        exporter.export_raw_video(frames, file.get());
+                    } else {
+                        exporter.export_png_sequence(frames, base_name, first);
+                    }
+                }
+            } catch (const std::exception&) {
+                success = false;
+            }
+            file->close();
+
+            emit this->images_exported(success, frame_count, frame_count / time.elapsed());
+        });
+    }
+}
+
+void MainWindow::export_images_finished(bool success, qint64 frame_count, double frame_rate) {
+    this->ui->actionExport_Images->setEnabled(true);
+
+    if (success) {
+        QMessageBox::information(this, this->windowTitle(),
+            tr("Exported %1 frames with %2 frames/s").arg(frame_count).arg(frame_rate));
+    } else {
+        QMessageBox::information(this, this->windowTitle(), tr("Cannot export images!"));
+    }
+}
+
+void MainWindow::on_actionExport_Text_triggered() {
+    // get export file name
+    QString file_name = QFileDialog::getSaveFileName(
+        this, "Export Text", "", "CSV File (*.csv);;TSV File (*.tsv)");
+
+    if (file_name != "") {
+        QFile file(file_name);
+        if (!file.open(QIODevice::WriteOnly)) {
+            QMessageBox::information(this, this->windowTitle(), tr("Cannot export text!"));
+            return;
+        }
+
+        // export played back recording or current data log
+        TextExporter exporter(file_name.endsWith(".tsv") ? '\t' : ',');
+        try {
+            double megabytes_per_second = 0.0;
+            if (this->log_player()) {
+                megabytes_per_second = exporter.export_log(this->log_player()->reader().get(), &file);
+            } else {
+                // convert data log to a temporary recording, which is streamed block wise
+                QTemporaryFile recording;
+                if (!recording.open()) {
+                    throw std::runtime_error("MainWindow: cannot create temporary recording");
+                }
+                recording.close();
+                LogReader reader;
+                bool saved = this->datalogger()->save_frames(recording.fileName(),
+                    this->ui->image->sigma_ref(), this->ui->image->nodes(), this->ui->image->elements(),
+                    this->ui->image->electrodes(), QJsonDocument(this->config()).toJson(QJsonDocument::Compact));
+                if (!saved || !reader.open(recording.fileName())) {
+                    throw std::runtime_error("MainWindow: cannot read data log");
+                }
+                megabytes_per_second = exporter.export_log(&reader, &file);
+            }
 
-        this->datalogger()->dump(&file);
+            QMessageBox::information(this, this->windowTitle(),
+                tr("Exported %1 MB with %2 MB/s").arg(exporter.bytes_written() * 1e-6)
+                .arg(megabytes_per_second));
+        } catch (const std::exception&) {
+            QMessageBox::information(this, this->windowTitle(), tr("Cannot export text!"));
+        }
         file.close();
     }
 }
@@ -301,18 +623,53 @@ void MainWindow::on_actionVersion_triggered() {
         tr("eitViewer"), GIT_VERSION, mpFlow::version::getVersionString()));
 }
 
+void MainWindow::save_latency_histograms() {
+    // get save file name
+    QString file_name = QFileDialog::getSaveFileName(
+        this, "Save Latency Histograms", "", "JSON File (*.json)");
+
+    // dump percentiles and all buckets of every stage
+    if (file_name != "") {
+        QFile file(file_name);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            QMessageBox::information(this, this->windowTitle(),
+                tr("Cannot save latency histograms!"));
+            return;
+        }
+        file.write(QJsonDocument(this->latency_tracer()->to_json(true)).toJson());
+    }
+}
+
+void MainWindow::save_profile_trace() {
+    // get save file name
+    QString file_name = QFileDialog::getSaveFileName(
+        this, "Save Profile Trace", "", "Chrome Trace (*.json)");
+
+    // trace can be opened with chrome://tracing or ui.perfetto.dev
+    if (file_name != "") {
+        QFile file(file_name);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            QMessageBox::information(this, this->windowTitle(),
+                tr("Cannot save profile trace!"));
+            return;
+        }
+        file.write(Profiler::chrome_trace());
+    }
+}
+
 void MainWindow::solver_initialized(bool success) {
     if (success) {
         // init image
         this->ui->image->init(this->solver()->eit_solver()->forward_solver()->model(),
             this->solver()->eit_solver()->dgamma()->rows(),
             this->solver()->eit_solver()->dgamma()->columns());
+        this->analysis_engine()->init(this->ui->image->element_area(), this->ui->image->sigma_ref(),
+            this->ui->image->mesh_generation(), std::make_shared<RegionsOfInterest>(this->ui->image->nodes(), this->ui->image->elements(),
+                this->ui->image->element_area()));
+        this->region_plot()->clear();
         qRegisterMetaType<Eigen::ArrayXXf>("Eigen::ArrayXXf");
-        connect(this->solver(), &Solver::data_ready, this->ui->image, &Image::update_data);
-
-        // init mirror server
-        this->_mirrorserver = new MirrorServer(this->ui->image, &this->analysis(), this);
-        connect(this->mirrorserver(), &MirrorServer::calibrate, this, &MainWindow::on_actionCalibrate_triggered);
+        qRegisterMetaType<std::shared_ptr<RenderFrames>>("std::shared_ptr<RenderFrames>");
+        this->latency_tracer()->reset();
 
         // set correct matrix for measurement system with meta object method call
         // to ensure matrix update not during data read or write
@@ -322,8 +679,10 @@ void MainWindow::solver_initialized(bool success) {
             Q_ARG(mpFlow::dtype::index, this->solver()->eit_solver()->measurement()[0]->rows()),
             Q_ARG(mpFlow::dtype::index, this->solver()->eit_solver()->measurement()[0]->columns()));
         connect(this->measurement_system(), &MeasurementSystem::data_ready, this->solver(), &Solver::solve);
-        connect(this->solver(), &Solver::data_ready, this->ui->image, &Image::update_data);
-        connect(this->solver(), &Solver::data_ready, this->datalogger(), &DataLogger::add_data);
+        connect(this->solver(), &Solver::data_ready, this->ui->image->render_preparer(),
+            &RenderPreparer::update_data);
+        connect(this->solver(), &Solver::data_ready, this->datalogger(), &DataLogger::add_data,
+            Qt::DirectConnection);
 
         // TODO
         this->analysis_timer_->start(20);
@@ -359,6 +718,22 @@ void MainWindow::update_solver_menu_items(bool success) {
     this->ui->actionRun_DataLogger->setEnabled(success);
     this->ui->actionReset_DataLogger->setEnabled(success);
     this->ui->actionSave_DataLogger->setEnabled(success);
+    this->ui->actionLog_Raw_Measurements->setEnabled(success);
+    this->ui->actionExport_Images->setEnabled(success);
+    this->ui->actionExport_Text->setEnabled(success);
+}
+
+void MainWindow::update_playback_menu_items(bool success) {
+    // update menu items and controls related to log playback
+    this->ui->actionClose_Solver->setEnabled(success);
+    this->ui->actionSave_Image->setEnabled(success);
+    this->ui->actionReset_View->setEnabled(success);
+    this->ui->actionDraw_Wireframe->setEnabled(success);
+    this->ui->actionInterpolate_Colors->setEnabled(success);
+    this->ui->actionExport_Text->setEnabled(success);
+    this->play_action()->setChecked(false);
+    this->playback_slider()->setValue(0);
+    this->playback_toolbar()->setVisible(success);
 }
 
 void MainWindow::update_calibrator_menu_items(bool success) {
@@ -389,6 +764,17 @@ void MainWindow::close_solver() {
         this->calibrator_ = nullptr;
     }
 
+    // stop and cleanup log playback
+    if (this->log_player()) {
+        this->update_playback_menu_items(false);
+        disconnect(this->playback_slider(), &QSlider::sliderMoved, this->log_player(),
+            &LogPlayer::seek);
+        disconnect(this->play_action(), &QAction::toggled, this->log_player(),
+            &LogPlayer::set_playing);
+        delete this->log_player();
+        this->log_player_ = nullptr;
+    }
+
     // stop and cleanup solver
     if (this->solver()) {
         // disable menu items
@@ -3,6 +3,11 @@
 
 #include <QMainWindow>
 #include <QTimer>
+#include <QToolBar>
+#include <QSlider>
+#include <QDockWidget>
+#include <QJsonObject>
+#include <QFuture>
 #include <functional>
 #include <mpflow/mpflow.h>
 #include "image.h"
@@ -11,6 +16,11 @@
 #include "calibrator.h"
 #include "datalogger.h"
 #include "mirrorserver.h"
+#include "analysisengine.h"
+#include "regionplot.h"
+#include "latencytracer.h"
+#include "latencyview.h"
+#include "logplayer.h"
 
 namespace Ui {
 class MainWindow;
@@ -22,10 +32,15 @@ class MainWindow : public QMainWindow {
 public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
-    
+
+signals:
+    void analysis_updated(QVariantList analysis);
+    void images_exported(bool success, qint64 frame_count, double frame_rate);
+
 private slots:
     void analyse();
     void on_actionOpen_triggered();
+    void on_actionOpen_Log_triggered();
     void on_actionExit_triggered();
     void on_actionLoad_Measurement_triggered();
     void on_actionSave_Measurement_triggered();
@@ -35,12 +50,18 @@ private slots:
     void on_actionSave_Image_triggered();
     void on_actionRun_DataLogger_toggled(bool arg1);
     void on_actionSave_DataLogger_triggered();
+    void on_actionExport_Images_triggered();
+    void on_actionExport_Text_triggered();
     void on_actionVersion_triggered();
+    void save_latency_histograms();
+    void save_profile_trace();
     void solver_initialized(bool success);
     void calibrator_initialized(bool success);
     void update_solver_menu_items(bool success);
     void update_calibrator_menu_items(bool success);
+    void update_playback_menu_items(bool success);
     void close_solver();
+    void export_images_finished(bool success, qint64 frame_count, double frame_rate);
 
 protected:
     void initTable();
@@ -55,11 +76,22 @@ public:
     Calibrator* calibrator() { return this->calibrator_; }
     DataLogger* datalogger() { return this->datalogger_; }
     MirrorServer* mirrorserver() { return this->_mirrorserver; }
+    AnalysisEngine* analysis_engine() { return this->analysis_engine_; }
+    FrameStatistics& statistics() { return this->statistics_; }
+    RegionPlot* region_plot() { return this->region_plot_; }
+    std::shared_ptr<LatencyTracer>& latency_tracer() { return this->latency_tracer_; }
+    LatencyView* latency_view() { return this->latency_view_; }
+    LogPlayer* log_player() { return this->log_player_; }
+    QToolBar* playback_toolbar() { return this->playback_toolbar_; }
+    QSlider* playback_slider() { return this->playback_slider_; }
+    QAction* play_action() { return this->play_action_; }
     std::vector<std::tuple<int, QString,
         std::function<mpFlow::dtype::real(const Eigen::Ref<Eigen::ArrayXf>&)>>>&
         analysisFunctions() { return this->analysisFunctions_; }
     std::vector<std::tuple<QString, QString>>& analysis() { return this->analysis_; }
     QString& open_file_name() { return this->open_file_name_; }
+    QFuture<void>& export_future() { return this->export_future_; }
+    QJsonObject& config() { return this->config_; }
 
 private:
     Ui::MainWindow *ui;
@@ -68,12 +100,23 @@ private:
     Calibrator* calibrator_;
     DataLogger* datalogger_;
     MirrorServer* _mirrorserver;
+    AnalysisEngine* analysis_engine_;
+    FrameStatistics statistics_;
+    RegionPlot* region_plot_;
+    std::shared_ptr<LatencyTracer> latency_tracer_;
+    LatencyView* latency_view_;
+    LogPlayer* log_player_;
+    QToolBar* playback_toolbar_;
+    QSlider* playback_slider_;
+    QAction* play_action_;
     std::vector<std::tuple<int, QString,
         std::function<mpFlow::dtype::real(const Eigen::Ref<Eigen::ArrayXf>&)>>>
         analysisFunctions_;
     std::vector<std::tuple<QString, QString>> analysis_;
     QTimer* analysis_timer_;
     QString open_file_name_;
+    QJsonObject config_;
+    QFuture<void> export_future_;
 };
 
 #endif // MAINWINDOW_H
@@ -1,11 +1,15 @@
 #include "measurementsystem.h"
+#include "profiler.h"
 #include <QDataStream>
+#include <algorithm>
 
 MeasurementSystem::MeasurementSystem(QObject* parent) :
     QObject(parent), measurement_system_socket_(nullptr), measurement_buffer_(nullptr),
-    buffer_pos_(0) {
+    buffer_pos_(0), trace_(nullptr), frame_id_(0), received_datagrams_(0), received_bytes_(0),
+    malformed_datagrams_(0), completed_batches_(0), max_pending_datagrams_(0) {
     // create separat thread
     this->thread_ = new QThread(this);
+    this->thread()->setObjectName("measurement system");
     this->moveToThread(this->thread());
 
     this->thread()->start();
@@ -25,11 +29,14 @@ void MeasurementSystem::init(mpFlow::dtype::index buffer_size, mpFlow::dtype::in
             mpFlow::dtype::real>>(rows, columns, nullptr);
     }
     this->buffer_pos() = 0;
+    this->trace() = nullptr;
 
     // create udp socket
     if (this->measurement_system_socket() == nullptr) {
         this->measurement_system_socket_ = new QUdpSocket(this);
         this->measurement_system_socket()->bind(3002, QUdpSocket::ShareAddress);
+        this->measurement_system_socket()->setSocketOption(
+            QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
         connect(this->measurement_system_socket(), &QUdpSocket::readyRead,
             this, &MeasurementSystem::readyRead);
     }
@@ -38,12 +45,56 @@ void MeasurementSystem::init(mpFlow::dtype::index buffer_size, mpFlow::dtype::in
 }
 
 void MeasurementSystem::readyRead() {
+    // readyRead is not emitted again for datagrams, which were already
+    // pending, so all of them have to be read at once
+    unsigned long long pending = 0;
+    while (this->measurement_system_socket()->hasPendingDatagrams()) {
+        this->read_datagram();
+        pending += 1;
+    }
+    if (pending > this->max_pending_datagrams()) {
+        this->max_pending_datagrams() = pending;
+    }
+}
+
+void MeasurementSystem::read_datagram() {
+    PROFILE_ZONE("ingest datagram");
+    double receive_time = HighPrecisionTime::now();
+
+    // datagrams too short for the measurement layout are discarded, trailing
+    // bytes of longer datagrams are ignored, like they always were
+    qint64 datagram_size = this->measurement_system_socket()->pendingDatagramSize();
+    qint64 measurement_size = this->measurement_buffer()[this->buffer_pos()]->rows() *
+        this->measurement_buffer()[this->buffer_pos()]->columns() * sizeof(mpFlow::dtype::real);
+    this->received_datagrams() += 1;
+    this->received_bytes() += std::max(datagram_size, (qint64)0);
+    if (datagram_size < measurement_size) {
+        this->measurement_system_socket()->readDatagram(nullptr, 0, nullptr, nullptr);
+        this->malformed_datagrams() += 1;
+        return;
+    }
+
     // read measurement data from one udp datagram
     QByteArray datagram;
-    datagram.resize(this->measurement_buffer()[this->buffer_pos()]->rows() *
-        this->measurement_buffer()[this->buffer_pos()]->columns() * sizeof(mpFlow::dtype::real));
-    this->measurement_system_socket()->readDatagram(datagram.data(),
-        datagram.size(), nullptr, nullptr);
+    datagram.resize(measurement_size);
+    if (this->measurement_system_socket()->readDatagram(datagram.data(),
+        datagram.size(), nullptr, nullptr) < 0) {
+        return;
+    }
+
+    // each batch carries its own trace through the pipeline, frame ids
+    // are only assigned to datagrams actually read
+    if ((this->buffer_pos() == 0) || (this->trace() == nullptr)) {
+        this->trace() = std::make_shared<FrameTrace>();
+        this->trace()->first_frame_id = this->frame_id();
+        this->trace()->receive.resize(this->measurement_buffer().size());
+    }
+    this->trace()->receive[this->buffer_pos()] = receive_time;
+    this->frame_id() += 1;
+
+    // raw measurement tap, e.g. for data logger
+    emit this->datagram_received(datagram, this->measurement_buffer()[this->buffer_pos()]->rows(),
+        this->measurement_buffer()[this->buffer_pos()]->columns());
 
     // extract measurement data
     QDataStream input_stream(datagram);
@@ -58,17 +109,27 @@ void MeasurementSystem::readyRead() {
 
     // emit data_ready signal when buffer is full
     if (this->buffer_pos() >= this->measurement_buffer().size()) {
+        PROFILE_ZONE("ingest batch");
+
+        // acquisition of batch is completed with last datagram
+        this->trace()->stamp(FrameTrace::batch_complete);
+        double timestamp = this->trace()->stamps[FrameTrace::batch_complete];
+
         // upload measurement buffer to gpu
         for (auto measurement : this->measurement_buffer()) {
             measurement->copyToDevice(nullptr);
         }
         cudaStreamSynchronize(nullptr);
+        this->trace()->stamp(FrameTrace::upload);
 
         // reset buffer pos
         this->buffer_pos() = 0;
 
         // emit signal for new data package ready
-        emit this->data_ready(&this->measurement_buffer(), this->time().elapsed());
+        emit this->data_ready(&this->measurement_buffer(), this->time().elapsed(), timestamp,
+            this->trace());
+        this->trace() = nullptr;
+        this->completed_batches() += 1;
         this->time().restart();
     }
 }
@@ -77,7 +138,14 @@ void MeasurementSystem::manual_override(std::shared_ptr<mpFlow::numeric::Matrix<
     for (auto measurement : this->measurement_buffer()) {
         measurement->copy(data, nullptr);
     }
-    emit this->data_ready(&this->measurement_buffer(), this->time().elapsed());
+
+    // manual data was not received, so its trace starts with upload
+    auto trace = std::make_shared<FrameTrace>();
+    trace->first_frame_id = this->frame_id();
+    trace->stamp(FrameTrace::batch_complete);
+    trace->stamp(FrameTrace::upload);
+    emit this->data_ready(&this->measurement_buffer(), this->time().elapsed(),
+        trace->stamps[FrameTrace::batch_complete], trace);
     this->time().restart();
 }
 
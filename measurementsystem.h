@@ -4,8 +4,10 @@
 #include <QObject>
 #include <QThread>
 #include <QUdpSocket>
+#include <atomic>
 #include <mpflow/mpflow.h>
 #include "highprecisiontime.h"
+#include "latencytracer.h"
 
 class MeasurementSystem : public QObject {
     Q_OBJECT
@@ -14,7 +16,10 @@ public:
 
 signals:
     void data_ready(std::vector<std::shared_ptr<mpFlow::numeric::Matrix<
-        mpFlow::dtype::real>>>* data, double time_elapsed=0.0);
+        mpFlow::dtype::real>>>* data, double time_elapsed=0.0, double timestamp=0.0,
+        std::shared_ptr<FrameTrace> trace=nullptr);
+    void datagram_received(QByteArray datagram, mpFlow::dtype::index rows,
+        mpFlow::dtype::index columns);
 
 public slots:
     void init(mpFlow::dtype::index buffer_size, mpFlow::dtype::index rows,
@@ -24,6 +29,9 @@ public slots:
         mpFlow::dtype::real>> data);
     std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::real>> get_current_measurement();
 
+protected:
+    void read_datagram();
+
 public:
     // accessors
     QUdpSocket* measurement_system_socket() { return this->measurement_system_socket_; }
@@ -33,6 +41,15 @@ public:
     QThread* thread() { return this->thread_; }
     HighPrecisionTime& time() { return this->time_; }
     mpFlow::dtype::index& buffer_pos() { return this->buffer_pos_; }
+    std::shared_ptr<FrameTrace>& trace() { return this->trace_; }
+    quint64& frame_id() { return this->frame_id_; }
+
+    // ingest counters, readable from any thread
+    std::atomic<unsigned long long>& received_datagrams() { return this->received_datagrams_; }
+    std::atomic<unsigned long long>& received_bytes() { return this->received_bytes_; }
+    std::atomic<unsigned long long>& malformed_datagrams() { return this->malformed_datagrams_; }
+    std::atomic<unsigned long long>& completed_batches() { return this->completed_batches_; }
+    std::atomic<unsigned long long>& max_pending_datagrams() { return this->max_pending_datagrams_; }
 
 // member
 private:
@@ -41,6 +58,13 @@ private:
     QThread* thread_;
     HighPrecisionTime time_;
     mpFlow::dtype::index buffer_pos_;
+    std::shared_ptr<FrameTrace> trace_;
+    quint64 frame_id_;
+    std::atomic<unsigned long long> received_datagrams_;
+    std::atomic<unsigned long long> received_bytes_;
+    std::atomic<unsigned long long> malformed_datagrams_;
+    std::atomic<unsigned long long> completed_batches_;
+    std::atomic<unsigned long long> max_pending_datagrams_;
 };
 
 #endif // MEASUREMENTSYSTEM_H
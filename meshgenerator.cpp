@@ -0,0 +1,36 @@
+#include <cmath>
+#include "meshgenerator.h"
+
+std::tuple<meshgenerator::Nodes, meshgenerator::Elements, meshgenerator::Elements>
+    meshgenerator::createMeshFromConfig(const QJsonObject& config) {
+    // extract parameter from config
+    distmesh::dtype::real radius = config["radius"].toDouble();
+    distmesh::dtype::array<distmesh::dtype::real> bounding_box(2, 2);
+    bounding_box << -1.1 * radius, 1.1 * radius, -1.1 * radius, 1.1 * radius;
+
+    // create mesh using libdistmesh
+    auto distance_function = distmesh::distance_function::circular(radius);
+    auto mesh = distmesh::distmesh(distance_function, config["outer_edge_length"].toDouble(),
+        1.0 + (1.0 - config["inner_edge_length"].toDouble() / config["outer_edge_length"].toDouble()) * distance_function / radius,
+        bounding_box);
+
+    // get boundary
+    auto boundary = distmesh::boundedges(std::get<1>(mesh));
+
+    return std::make_tuple(std::get<0>(mesh), std::get<1>(mesh), boundary);
+}
+
+Eigen::ArrayXXd meshgenerator::createElectrodesFromConfig(const QJsonObject& config) {
+    double radius = config["mesh"].toObject()["radius"].toDouble();
+    double width = config["electrodes"].toObject()["width"].toDouble();
+    Eigen::Index count = config["electrodes"].toObject()["count"].toDouble();
+
+    Eigen::ArrayXXd electrodes(2 * 2, count);
+    for (Eigen::Index electrode = 0; electrode < count; ++electrode) {
+        double angle = 2.0 * M_PI * electrode / count;
+        electrodes.col(electrode) << radius * std::cos(angle), radius * std::sin(angle),
+            radius * std::cos(angle + width / radius), radius * std::sin(angle + width / radius);
+    }
+
+    return electrodes;
+}
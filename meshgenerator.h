@@ -0,0 +1,24 @@
+#ifndef MESHGENERATOR_H
+#define MESHGENERATOR_H
+
+#include <QJsonObject>
+#include <tuple>
+#include <Eigen/Dense>
+#include <distmesh/distmesh.h>
+
+// model geometry of a solver config, shared by gpu solver and cpu forward
+// simulator, so simulated measurements match the reconstruction model
+namespace meshgenerator {
+    typedef distmesh::dtype::array<distmesh::dtype::real> Nodes;
+    typedef distmesh::dtype::array<distmesh::dtype::index> Elements;
+
+    // nodes, elements and boundary edges for mesh section of config
+    std::tuple<Nodes, Elements, Elements> createMeshFromConfig(const QJsonObject& config);
+
+    // start (x0, y0) and end point (x1, y1) of each electrode as column for model
+    // section of config, placed like mpFlow::EIT::electrodes::circularBoundary does:
+    // electrode i starts at angle 2 pi i / count and covers its width counterclockwise
+    Eigen::ArrayXXd createElectrodesFromConfig(const QJsonObject& config);
+}
+
+#endif // MESHGENERATOR_H
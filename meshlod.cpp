@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include "meshlod.h"
+
+MeshLOD::MeshLOD(const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::ArrayXf& node_area, const Eigen::ArrayXf& element_area,
+    mpFlow::dtype::index min_elements) {
+    // full resolution mesh is used as is
+    Level full;
+    full.nodes = nodes;
+    full.elements = elements;
+    this->levels().push_back(full);
+
+    // elements connected to each node
+    std::vector<std::vector<mpFlow::dtype::index>> node_elements(nodes.cols());
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element)
+    for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+        node_elements[elements(element, node)].push_back(element);
+    }
+
+    // double clustering cell size starting at mean edge length until mesh is coarse enough
+    double cell_size = std::sqrt(2.0 * element_area.mean());
+    while ((this->levels().back().elements.rows() > min_elements) &&
+        (cell_size < 1.0)) {
+        cell_size *= 2.0;
+        Level level = MeshLOD::simplify(nodes, elements, node_area, element_area,
+            node_elements, cell_size);
+
+        // only keep levels, which reduce element count significantly
+        if ((level.elements.rows() > 0) &&
+            (level.elements.rows() < this->levels().back().elements.rows() * 3 / 4)) {
+            this->levels().push_back(level);
+        }
+    }
+}
+
+mpFlow::dtype::index MeshLOD::select_level(double pixels, double pixels_per_element) {
+    // finest level without more elements than pixels can show
+    for (mpFlow::dtype::index level = 0; level < this->levels().size(); ++level) {
+        if (this->levels()[level].elements.rows() * pixels_per_element <= pixels) {
+            return level;
+        }
+    }
+
+    return this->levels().size() - 1;
+}
+
+MeshLOD::Level MeshLOD::simplify(const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::ArrayXf& node_area, const Eigen::ArrayXf& element_area,
+    const std::vector<std::vector<mpFlow::dtype::index>>& node_elements, double cell_size) {
+    Level level;
+
+    // assign each node to a grid cell cluster
+    std::map<std::pair<long, long>, mpFlow::dtype::index> cells;
+    std::vector<mpFlow::dtype::index> node_cluster(nodes.cols());
+    std::vector<std::vector<mpFlow::dtype::index>> cluster_nodes;
+    for (mpFlow::dtype::index node = 0; node < nodes.cols(); ++node) {
+        auto cell = std::make_pair((long)std::floor(nodes(0, node) / cell_size),
+            (long)std::floor(nodes(1, node) / cell_size));
+        auto result = cells.insert(std::make_pair(cell, (mpFlow::dtype::index)cluster_nodes.size()));
+        if (result.second) {
+            cluster_nodes.push_back(std::vector<mpFlow::dtype::index>());
+        }
+        node_cluster[node] = result.first->second;
+        cluster_nodes[node_cluster[node]].push_back(node);
+    }
+
+    // coarse nodes are area weighted centers of clusters
+    level.nodes = Eigen::ArrayXXf::Zero(2, cluster_nodes.size());
+    std::vector<Eigen::Triplet<float>> node_weights;
+    for (mpFlow::dtype::index cluster = 0; cluster < cluster_nodes.size(); ++cluster) {
+        float area = 0.0;
+        for (const auto node : cluster_nodes[cluster]) {
+            area += node_area(node);
+        }
+        for (const auto node : cluster_nodes[cluster]) {
+            level.nodes.col(cluster) += nodes.col(node) * node_area(node) / area;
+            node_weights.push_back(Eigen::Triplet<float>(cluster, node, node_area(node) / area));
+        }
+    }
+    level.node_restriction.resize(cluster_nodes.size(), nodes.cols());
+    level.node_restriction.setFromTriplets(node_weights.begin(), node_weights.end());
+
+    // elements spanning three different clusters survive as coarse elements
+    std::map<std::array<mpFlow::dtype::index, 3>, mpFlow::dtype::index> coarse_elements;
+    std::vector<std::array<mpFlow::dtype::index, 3>> coarse_element_nodes;
+    std::vector<std::vector<mpFlow::dtype::index>> cluster_elements(cluster_nodes.size());
+    level.element_mapping = Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, 1>::Constant(
+        elements.rows(), std::numeric_limits<mpFlow::dtype::index>::max());
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element) {
+        std::array<mpFlow::dtype::index, 3> clusters = {{ node_cluster[elements(element, 0)],
+            node_cluster[elements(element, 1)], node_cluster[elements(element, 2)] }};
+        if ((clusters[0] == clusters[1]) || (clusters[1] == clusters[2]) ||
+            (clusters[0] == clusters[2])) {
+            continue;
+        }
+
+        std::array<mpFlow::dtype::index, 3> key = clusters;
+        std::sort(key.begin(), key.end());
+        auto result = coarse_elements.insert(std::make_pair(key,
+            (mpFlow::dtype::index)coarse_element_nodes.size()));
+        if (result.second) {
+            coarse_element_nodes.push_back(clusters);
+            for (const auto cluster : clusters) {
+                cluster_elements[cluster].push_back(result.first->second);
+            }
+        }
+        level.element_mapping(element) = result.first->second;
+    }
+
+    level.elements.resize(coarse_element_nodes.size(), 3);
+    for (mpFlow::dtype::index element = 0; element < coarse_element_nodes.size(); ++element)
+    for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+        level.elements(element, node) = coarse_element_nodes[element][node];
+    }
+    if (level.elements.rows() == 0) {
+        return level;
+    }
+
+    // centers of coarse elements
+    Eigen::ArrayXXf centers = Eigen::ArrayXXf::Zero(2, level.elements.rows());
+    for (mpFlow::dtype::index element = 0; element < level.elements.rows(); ++element) {
+        centers.col(element) = (level.nodes.col(level.elements(element, 0)) +
+            level.nodes.col(level.elements(element, 1)) +
+            level.nodes.col(level.elements(element, 2))) / 3.0;
+    }
+
+    // map collapsed elements to the coarse element containing their center,
+    // or to the nearest coarse element around their clusters
+    auto contains = [&](mpFlow::dtype::index element, const Eigen::Array2f& point) {
+        Eigen::Array2f a = level.nodes.col(level.elements(element, 0));
+        Eigen::Array2f b = level.nodes.col(level.elements(element, 1));
+        Eigen::Array2f c = level.nodes.col(level.elements(element, 2));
+        float d0 = (b(0) - a(0)) * (point(1) - a(1)) - (b(1) - a(1)) * (point(0) - a(0));
+        float d1 = (c(0) - b(0)) * (point(1) - b(1)) - (c(1) - b(1)) * (point(0) - b(0));
+        float d2 = (a(0) - c(0)) * (point(1) - c(1)) - (a(1) - c(1)) * (point(0) - c(0));
+        return ((d0 >= 0.0) && (d1 >= 0.0) && (d2 >= 0.0)) ||
+            ((d0 <= 0.0) && (d1 <= 0.0) && (d2 <= 0.0));
+    };
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element) {
+        if (level.element_mapping(element) != std::numeric_limits<mpFlow::dtype::index>::max()) {
+            continue;
+        }
+
+        Eigen::Array2f center = (nodes.col(elements(element, 0)) + nodes.col(elements(element, 1)) +
+            nodes.col(elements(element, 2))) / 3.0;
+        std::vector<mpFlow::dtype::index> candidates;
+        for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+            const auto& adjacent = cluster_elements[node_cluster[elements(element, node)]];
+            candidates.insert(candidates.end(), adjacent.begin(), adjacent.end());
+        }
+        if (candidates.empty()) {
+            candidates.resize(level.elements.rows());
+            for (mpFlow::dtype::index i = 0; i < candidates.size(); ++i) {
+                candidates[i] = i;
+            }
+        }
+
+        mpFlow::dtype::index best = candidates[0];
+        float best_distance = std::numeric_limits<float>::max();
+        for (const auto candidate : candidates) {
+            if (contains(candidate, center)) {
+                best = candidate;
+                break;
+            }
+            float distance = (centers.col(candidate) - center).matrix().squaredNorm();
+            if (distance < best_distance) {
+                best = candidate;
+                best_distance = distance;
+            }
+        }
+        level.element_mapping(element) = best;
+    }
+
+    // coarse element values are area weighted averages of all mapped elements
+    Eigen::ArrayXf coarse_area = Eigen::ArrayXf::Zero(level.elements.rows());
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element) {
+        coarse_area(level.element_mapping(element)) += element_area(element);
+    }
+    std::vector<Eigen::Triplet<float>> element_weights;
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element) {
+        element_weights.push_back(Eigen::Triplet<float>(level.element_mapping(element), element,
+            element_area(element) / coarse_area(level.element_mapping(element))));
+    }
+
+    // coarse elements without mapped elements take the nearest element around their nodes
+    for (mpFlow::dtype::index element = 0; element < level.elements.rows(); ++element) {
+        if (coarse_area(element) > 0.0) {
+            continue;
+        }
+
+        mpFlow::dtype::index best = 0;
+        float best_distance = std::numeric_limits<float>::max();
+        for (mpFlow::dtype::index node = 0; node < 3; ++node)
+        for (const auto cluster_node : cluster_nodes[level.elements(element, node)])
+        for (const auto candidate : node_elements[cluster_node]) {
+            Eigen::Array2f center = (nodes.col(elements(candidate, 0)) +
+                nodes.col(elements(candidate, 1)) + nodes.col(elements(candidate, 2))) / 3.0;
+            float distance = (centers.col(element) - center).matrix().squaredNorm();
+            if (distance < best_distance) {
+                best = candidate;
+                best_distance = distance;
+            }
+        }
+        element_weights.push_back(Eigen::Triplet<float>(element, best, 1.0));
+    }
+    level.element_restriction.resize(level.elements.rows(), elements.rows());
+    level.element_restriction.setFromTriplets(element_weights.begin(), element_weights.end());
+
+    return level;
+}
@@ -0,0 +1,43 @@
+#ifndef MESHLOD_H
+#define MESHLOD_H
+
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <mpflow/mpflow.h>
+
+// hierarchy of simplified display meshes created by vertex clustering,
+// level 0 is the full resolution mesh, each coarser level carries sparse
+// operators restricting full resolution node and element values onto it
+class MeshLOD {
+public:
+    struct Level {
+        Eigen::ArrayXXf nodes;
+        Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic> elements;
+        Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, 1> element_mapping;
+        Eigen::SparseMatrix<float, Eigen::RowMajor> node_restriction;
+        Eigen::SparseMatrix<float, Eigen::RowMajor> element_restriction;
+    };
+
+    MeshLOD(const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::ArrayXf& node_area, const Eigen::ArrayXf& element_area,
+        mpFlow::dtype::index min_elements=256);
+
+    mpFlow::dtype::index select_level(double pixels, double pixels_per_element=4.0);
+
+protected:
+    static Level simplify(const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::ArrayXf& node_area, const Eigen::ArrayXf& element_area,
+        const std::vector<std::vector<mpFlow::dtype::index>>& node_elements, double cell_size);
+
+public:
+    // accessors
+    std::vector<Level>& levels() { return this->levels_; }
+
+private:
+    std::vector<Level> levels_;
+};
+
+#endif // MESHLOD_H
@@ -0,0 +1,118 @@
+#include <cstring>
+#include "mirrorencoder.h"
+#include "colormap.h"
+
+MirrorEncoder::MirrorEncoder(Format format, bool delta, int keyframe_interval) :
+    format_(format), delta_(delta), keyframe_(true), keyframe_interval_(keyframe_interval),
+    frames_since_keyframe_(keyframe_interval), previous_frame_id_(0) {
+}
+
+QByteArray MirrorEncoder::encode(quint64 frame_id,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::Ref<const Eigen::ArrayXf>& z_values,
+    const Eigen::Ref<const Eigen::ArrayXf>& element_values, bool interpolate_colors) {
+    this->keyframe_ = true;
+    if (this->format() == float32) {
+        return this->encode_float(frame_id, elements, z_values, element_values, interpolate_colors);
+    }
+    return this->encode_compact(frame_id, z_values, element_values, interpolate_colors);
+}
+
+QByteArray MirrorEncoder::encode_float(quint64 frame_id,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::Ref<const Eigen::ArrayXf>& z_values,
+    const Eigen::Ref<const Eigen::ArrayXf>& element_values, bool interpolate_colors) {
+    // z values of all element vertices and color of each element
+    Eigen::ArrayXXf vertices(3, elements.rows());
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element)
+    for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+        vertices(node, element) = 1.0 - 2.0 * z_values(elements(element, node));
+    }
+    Eigen::ArrayXXf colors;
+    if (interpolate_colors) {
+        Eigen::ArrayXf first_node_values(elements.rows());
+        for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element) {
+            first_node_values(element) = z_values(elements(element, 0));
+        }
+        colors = colormap::jet(first_node_values).transpose();
+    } else {
+        colors = colormap::jet(element_values).transpose();
+    }
+
+    mirrorprotocol::FrameHeader header;
+    header.magic = mirrorprotocol::frame_magic;
+    header.size = sizeof(float) * (vertices.size() + colors.size());
+    header.frame_id = frame_id;
+    header.element_count = elements.rows();
+    header.node_count = z_values.size();
+
+    QByteArray message;
+    message.reserve(sizeof(header) + header.size);
+    message.append((const char*)&header, sizeof(header));
+    message.append((const char*)vertices.data(), sizeof(float) * vertices.size());
+    message.append((const char*)colors.data(), sizeof(float) * colors.size());
+
+    return message;
+}
+
+QByteArray MirrorEncoder::encode_compact(quint64 frame_id,
+    const Eigen::Ref<const Eigen::ArrayXf>& z_values,
+    const Eigen::Ref<const Eigen::ArrayXf>& element_values, bool interpolate_colors) {
+    // quantize normalized node and element values
+    quint32 levels = (1u << this->format()) - 1;
+    Eigen::Array<quint32, Eigen::Dynamic, 1> values(z_values.size() + element_values.size());
+    values.head(z_values.size()) = (z_values.max(0.0).min(1.0) * levels + 0.5).cast<quint32>();
+    values.tail(element_values.size()) =
+        (element_values.max(0.0).min(1.0) * levels + 0.5).cast<quint32>();
+
+    // code as difference to previous frame modulo value range, regular
+    // keyframes let clients join or recover from missed frames
+    mirrorprotocol::CompactFrameHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = mirrorprotocol::compact_frame_magic;
+    header.frame_id = frame_id;
+    header.element_count = element_values.size();
+    header.node_count = z_values.size();
+    header.bits = this->format();
+    header.flags = interpolate_colors ? mirrorprotocol::interpolate_colors : 0;
+
+    Eigen::Array<quint32, Eigen::Dynamic, 1> coded = values;
+    if (this->delta()) {
+        header.flags |= mirrorprotocol::compressed;
+        if ((this->frames_since_keyframe_ < this->keyframe_interval_) &&
+            (this->previous_values_.size() == values.size())) {
+            header.flags |= mirrorprotocol::delta;
+            header.base_frame_id = this->previous_frame_id_;
+            this->keyframe_ = false;
+            for (mpFlow::dtype::index i = 0; i < values.size(); ++i) {
+                coded(i) = (values(i) - this->previous_values_(i)) & levels;
+            }
+            this->frames_since_keyframe_ += 1;
+        } else {
+            this->frames_since_keyframe_ = 1;
+        }
+        this->previous_values_ = values;
+        this->previous_frame_id_ = frame_id;
+    }
+
+    // little endian packed values
+    QByteArray payload;
+    if (this->format() == uint8) {
+        Eigen::Array<quint8, Eigen::Dynamic, 1> packed = coded.cast<quint8>();
+        payload = QByteArray((const char*)packed.data(), packed.size());
+    } else {
+        Eigen::Array<quint16, Eigen::Dynamic, 1> packed = coded.cast<quint16>();
+        payload = QByteArray((const char*)packed.data(), sizeof(quint16) * packed.size());
+    }
+    if (header.flags & mirrorprotocol::compressed) {
+        payload = qCompress(payload, 1);
+    }
+    header.size = payload.size();
+
+    QByteArray message;
+    message.reserve(sizeof(header) + payload.size());
+    message.append((const char*)&header, sizeof(header));
+    message.append(payload);
+
+    return message;
+}
@@ -0,0 +1,54 @@
+#ifndef MIRRORENCODER_H
+#define MIRRORENCODER_H
+
+#include <QByteArray>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+#include "mirrorprotocol.h"
+
+// encodes presented frames as stream messages for mirror clients, the float
+// format matches the polling endpoints, the compact formats quantize the one
+// normalized value per node and element, which all vertices and colors are
+// derived from, and optionally code it as delta to the previous frame
+class MirrorEncoder {
+public:
+    enum Format {
+        float32 = 0,
+        uint8 = 8,
+        uint16 = 16
+    };
+
+    explicit MirrorEncoder(Format format=float32, bool delta=false, int keyframe_interval=32);
+
+    QByteArray encode(quint64 frame_id,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::Ref<const Eigen::ArrayXf>& z_values,
+        const Eigen::Ref<const Eigen::ArrayXf>& element_values, bool interpolate_colors);
+    void request_keyframe() { this->frames_since_keyframe_ = this->keyframe_interval_; }
+
+protected:
+    QByteArray encode_float(quint64 frame_id,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::Ref<const Eigen::ArrayXf>& z_values,
+        const Eigen::Ref<const Eigen::ArrayXf>& element_values, bool interpolate_colors);
+    QByteArray encode_compact(quint64 frame_id,
+        const Eigen::Ref<const Eigen::ArrayXf>& z_values,
+        const Eigen::Ref<const Eigen::ArrayXf>& element_values, bool interpolate_colors);
+
+public:
+    // accessors
+    Format format() { return this->format_; }
+    bool delta() { return this->delta_; }
+    bool keyframe() { return this->keyframe_; }
+
+private:
+    Format format_;
+    bool delta_;
+    bool keyframe_;
+    int keyframe_interval_;
+    int frames_since_keyframe_;
+    quint64 previous_frame_id_;
+    Eigen::Array<quint32, Eigen::Dynamic, 1> previous_values_;
+};
+
+#endif // MIRRORENCODER_H
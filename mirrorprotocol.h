@@ -0,0 +1,76 @@
+#ifndef MIRRORPROTOCOL_H
+#define MIRRORPROTOCOL_H
+
+#include <cstdint>
+
+// binary messages pushed to mirror clients subscribed to /stream, the
+// response is sent with chunked transfer encoding and carries a sequence of
+// messages, each one starting with a frame header followed by size bytes of
+// payload, so clients can split the stream independent of chunk boundaries
+namespace mirrorprotocol {
+    // magic bytes 'EITF' in little endian order
+    const uint32_t frame_magic = 0x46544945;
+
+    // payload of float frames: 3 z values per element followed by
+    // rgb colors per element, matching /vertices-update and /colors-update
+    struct FrameHeader {
+        uint32_t magic;
+        uint32_t size;
+        uint64_t frame_id;
+        uint32_t element_count;
+        uint32_t node_count;
+    };
+
+    // magic bytes 'EITQ' in little endian order
+    const uint32_t compact_frame_magic = 0x51544945;
+
+    // flags of compact frames
+    enum CompactFlags : uint8_t {
+        interpolate_colors = 1,
+        delta = 2,
+        compressed = 4
+    };
+
+    // payload of compact frames: one value of given bits per node followed by
+    // one value per element, each one the normalized value scaled to the full
+    // range of bits, little endian. Delta frames hold the difference to frame
+    // base_frame_id modulo the value range, compressed payloads are zlib
+    // streams prefixed by their big endian uncompressed size, like qCompress
+    struct CompactFrameHeader {
+        uint32_t magic;
+        uint32_t size;
+        uint64_t frame_id;
+        uint64_t base_frame_id;
+        uint32_t element_count;
+        uint32_t node_count;
+        uint8_t bits;
+        uint8_t flags;
+        uint16_t reserved;
+        uint32_t reserved2;
+    };
+
+    // magic bytes 'EITB' in little endian order
+    const uint32_t batch_magic = 0x42544945;
+
+    // response of /frames?since=<id>: all frames of the history after given
+    // frame id, each one as uint64 frame id, int64 wall clock timestamp in ms
+    // and rows float32 reconstructed values. The history holds every
+    // reconstructed frame, also those skipped by the display, so its ids count
+    // reconstructed frames and are independent of stream frame ids. A
+    // first_frame_id larger than since + 1 tells the client, that frames in
+    // between are no longer available
+    struct BatchHeader {
+        uint32_t magic;
+        uint32_t frame_count;
+        uint32_t rows;
+        uint32_t reserved;
+        uint64_t first_frame_id;
+        uint64_t last_frame_id;
+    };
+
+    static_assert(sizeof(FrameHeader) == 24, "unexpected padding of mirror frame header");
+    static_assert(sizeof(CompactFrameHeader) == 40, "unexpected padding of mirror compact frame header");
+    static_assert(sizeof(BatchHeader) == 32, "unexpected padding of mirror batch header");
+}
+
+#endif // MIRRORPROTOCOL_H
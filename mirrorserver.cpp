@@ -1,125 +1,571 @@
 #include "mirrorserver.h"
 #include <QDataStream>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <QUrlQuery>
+#include <QDateTime>
+#include <algorithm>
+#include <random>
+#include "colormap.h"
+#include "highprecisiontime.h"
+#include "profiler.h"
 
-MirrorServer::MirrorServer(Image* image, std::vector<std::tuple<QString, QString>>* analysis, QObject* parent) :
-    QObject(parent), _image(image), _analysis(analysis) {
-    // create http server
+MirrorServer::MirrorServer(quint16 port, size_t max_subscribers, size_t max_queued_frames,
+    double history_duration, size_t history_bytes, QObject* parent) :
+    QObject(parent), _httpServer(nullptr), mesh_generation_(0), analysis_generation_(0),
+    cache_hits_(0), cache_misses_(0), not_modified_(0), max_subscribers_(max_subscribers),
+    max_queued_frames_(max_queued_frames), rejected_subscribers_(0),
+    history_(history_duration, history_bytes), history_frame_id_(0),
+    region_history_(history_duration, history_bytes / 16),
+    latency_tracer_(nullptr) {
+    // generations restart with every process, a random nonce keeps tags of
+    // a previous run from matching, when clients revalidate after a restart
+    std::random_device random;
+    this->instance_tag() = QByteArray::number(
+        ((quint64)random() << 32) ^ random() ^ (quint64)QDateTime::currentMSecsSinceEpoch(), 36);
+
+    // create separat thread, so serving clients never blocks rendering
+    this->thread_ = new QThread(this);
+    this->thread()->setObjectName("mirror server");
+    this->moveToThread(this->thread());
+    this->thread()->start();
+
+    // create http server within server thread
+    QMetaObject::invokeMethod(this, "listen", Qt::QueuedConnection, Q_ARG(quint16, port));
+}
+
+void MirrorServer::listen(quint16 port) {
     this->_httpServer = new QHttpServer(this);
     connect(this->httpServer(), &QHttpServer::newRequest, this, &MirrorServer::handleRequest);
 
     // start listening
-    this->httpServer()->listen(QHostAddress::Any, 3003);
+    this->httpServer()->listen(QHostAddress::Any, port);
 }
 
-void MirrorServer::handleRequest(QHttpRequest *request, QHttpResponse *response) {
-    Q_UNUSED(response);
+void MirrorServer::update_mesh(std::shared_ptr<const MirrorMesh> mesh) {
+    this->mesh() = mesh;
+    this->frame() = nullptr;
+    this->mesh_generation() += 1;
+    this->history().reset(0);
 
+    // stream clients have to restart with a keyframe of new mesh
+    for (auto& encoder : this->encoders()) {
+        encoder.second->request_keyframe();
+    }
+    for (auto& subscriber : this->subscribers()) {
+        subscriber->queue.clear();
+        subscriber->needs_keyframe = subscriber->encoder->delta();
+    }
+}
+
+void MirrorServer::update_analysis(QVariantList analysis) {
+    // unchanged results keep their tag, so clients get not modified responses
+    if (analysis != this->analysis()) {
+        this->analysis() = analysis;
+        this->analysis_generation() += 1;
+    }
+}
+
+bool MirrorServer::snapshot_ready() {
+    return this->mesh() && this->frame() && this->frame()->matches(*this->mesh());
+}
+
+void MirrorServer::handleRequest(QHttpRequest *request, QHttpResponse *response) {
     // call response handler according to request type
     if (request->path() == "/electrodes") {
-        this->handleElectrodesConfigRequest(response);
+        this->handleElectrodesConfigRequest(request, response);
     }
     else if (request->path() == "/vertices") {
-        this->handleVerticesConfigRequest(response);
+        this->handleVerticesConfigRequest(request, response);
     }
     else if (request->path() == "/colors") {
-        this->handleColorConfigRequest(response);
+        this->handleColorConfigRequest(request, response);
     }
     else if (request->path() == "/vertices-update") {
-        this->handleVerticesUpdateRequest(response);
+        this->handleVerticesUpdateRequest(request, response);
     }
     else if (request->path() == "/colors-update") {
-        this->handleColorUpdateRequest(response);
+        this->handleColorUpdateRequest(request, response);
     }
     else if (request->path() == "/analysis-update") {
-        this->handleAnalysisUpdateRequest(response);
+        this->handleAnalysisUpdateRequest(request, response);
     }
     else if (request->path() == "/calibrate") {
         this->handleCalibrateRequest(response);
     }
+    else if (request->path() == "/mesh") {
+        this->handleMeshRequest(request, response);
+    }
+    else if (request->path() == "/stream") {
+        this->handleStreamRequest(request, response);
+    }
+    else if (request->path() == "/stats") {
+        this->handleStatsRequest(response);
+    }
+    else if (request->path() == "/frames") {
+        this->handleFramesRequest(request, response);
+    }
+    else if (request->path() == "/regions") {
+        this->handleRegionsRequest(request, response);
+    }
+    else if (request->path() == "/region-names") {
+        this->handleRegionNamesRequest(response);
+    }
+    else if (request->path() == "/latency") {
+        this->handleLatencyRequest(request, response);
+    }
+    else if (request->path() == "/trace") {
+        this->handleTraceRequest(response);
+    }
 }
 
-void MirrorServer::handleElectrodesConfigRequest(QHttpResponse *response) {
-    QByteArray vertices = QByteArray::fromRawData((const char*)this->image()->electrodes().data(),
-        sizeof(float) * this->image()->electrodes().rows() * this->image()->electrodes().cols());
-    QByteArray colors = QByteArray::fromRawData((const char*)this->image()->electrode_colors().data(),
-        sizeof(float) * this->image()->electrode_colors().rows() * this->image()->electrode_colors().cols());
-    QByteArray body = vertices.append(colors);
+void MirrorServer::respond(QHttpRequest* request, QHttpResponse* response, const QByteArray& tag,
+    std::function<QByteArray()> serialize) {
+    // snapshot data is not available, yet
+    if (tag.isEmpty()) {
+        response->writeHead(503);
+        response->end();
+        return;
+    }
+
+    // client still has current data
+    QByteArray etag = "\"" + tag + "\"";
+    for (const auto& match : request->header("if-none-match").split(',')) {
+        if ((match.trimmed().toUtf8() == etag) || (match.trimmed() == "*")) {
+            this->not_modified() += 1;
+            response->setHeader("ETag", etag);
+            response->writeHead(304);
+            response->end();
+            return;
+        }
+    }
 
-    response->setHeader("Content-Length", QString::number(body.length()));
+    // serialize payload only once per tag, independent of number of clients
+    CacheEntry& entry = this->cache()[request->path()];
+    if (entry.tag == tag) {
+        this->cache_hits() += 1;
+    } else {
+        this->cache_misses() += 1;
+        entry.tag = tag;
+        entry.body = serialize();
+    }
+
+    response->setHeader("Content-Length", QString::number(entry.body.length()));
+    response->setHeader("Cache-Control", "no-cache");
+    response->setHeader("ETag", etag);
     response->writeHead(200);
-    response->end(body);
+    response->end(entry.body);
+}
+
+QByteArray MirrorServer::mesh_tag() {
+    if (!this->mesh()) {
+        return QByteArray();
+    }
+    return this->instance_tag() + "-m" + QByteArray::number(this->mesh_generation());
 }
 
-void MirrorServer::handleVerticesConfigRequest(QHttpResponse *response) {
-    // fill dictionary with config data
-    QByteArray vertices = QByteArray::fromRawData((const char*)this->image()->vertices().data(),
-        sizeof(float) * this->image()->vertices().rows() * this->image()->vertices().cols());
+QByteArray MirrorServer::frame_tag() {
+    if (!this->snapshot_ready()) {
+        return QByteArray();
+    }
+    return this->mesh_tag() + "-f" + QByteArray::number(this->frame()->frame_id);
+}
 
-    response->setHeader("Content-Length", QString::number(vertices.length()));
-    response->writeHead(200);
-    response->end(vertices);
+QByteArray MirrorServer::analysis_tag() {
+    return this->instance_tag() + "-a" + QByteArray::number(this->analysis_generation());
 }
 
-void MirrorServer::handleVerticesUpdateRequest(QHttpResponse *response) {
-    // fill dictionary with config data
-    Eigen::ArrayXXf vertices = Eigen::ArrayXXf::Zero(3, this->image()->vertices().cols());
-    vertices.row(0) = this->image()->vertices().row(2 + 0 * 3).eval();
-    vertices.row(1) = this->image()->vertices().row(2 + 1 * 3).eval();
-    vertices.row(2) = this->image()->vertices().row(2 + 2 * 3).eval();
-    QByteArray verticesByteArray = QByteArray::fromRawData((const char*)vertices.data(),
-        sizeof(float) * vertices.rows() * vertices.cols());
+void MirrorServer::publish_frame(std::shared_ptr<const MirrorFrame> frame) {
+    PROFILE_ZONE("mirror publish");
+
+    // keep latest frame for polling clients
+    if (!this->mesh() || !frame->matches(*this->mesh())) {
+        return;
+    }
+    this->frame() = frame;
+
+    if (this->subscribers().empty()) {
+        return;
+    }
+
+    // encode frame once per format and hand it to all subscribers of that format
+    for (auto& encoder : this->encoders()) {
+        QByteArray message = encoder.second->encode(frame->frame_id, this->mesh()->elements,
+            frame->z_values(), frame->element_values().head(this->mesh()->elements.rows()),
+            frame->interpolate_colors);
 
-    response->setHeader("Content-Length", QString::number(verticesByteArray.length()));
+        QueuedFrame queued = { frame->frame_id, message, frame->presentation_time };
+        for (const auto& subscriber : this->subscribers()) {
+            if (subscriber->encoder != encoder.second.get()) {
+                continue;
+            }
+
+            // clients joining or falling behind get a keyframe of their own, the
+            // shared encoder keeps coding deltas for all others, following deltas
+            // refer to this frame and apply to the keyframe as well
+            if (subscriber->needs_keyframe && !encoder.second->keyframe()) {
+                subscriber->keyframe_encoder->request_keyframe();
+                QueuedFrame keyframe = { frame->frame_id, subscriber->keyframe_encoder->encode(
+                    frame->frame_id, this->mesh()->elements, frame->z_values(),
+                    frame->element_values().head(this->mesh()->elements.rows()),
+                    frame->interpolate_colors), frame->presentation_time };
+                this->enqueue(*subscriber, keyframe, true);
+            } else {
+                this->enqueue(*subscriber, queued, encoder.second->keyframe());
+            }
+        }
+    }
+}
+
+void MirrorServer::update_history(std::shared_ptr<RenderFrames> frames, double) {
+    PROFILE_ZONE("mirror history");
+
+    // history keeps every reconstructed frame with wall clock time stamps, not
+    // only the presented ones, batches of a previous mesh are skipped
+    const auto& data = frames->data;
+    if (!this->mesh() || (data.rows() != this->mesh()->elements.rows())) {
+        return;
+    }
+    if (this->history().rows() != data.rows()) {
+        this->history().reset(data.rows());
+    }
+    for (mpFlow::dtype::index column = 0; column < data.cols(); ++column) {
+        qint64 timestamp = column < frames->timestamps.size() ?
+            HighPrecisionTime::wall_clock(frames->timestamps(column)) :
+            QDateTime::currentMSecsSinceEpoch();
+        this->history_frame_id() += 1;
+        this->history().push(this->history_frame_id(), timestamp, data.col(column));
+    }
+}
+
+void MirrorServer::update_regions(std::shared_ptr<const RegionSamples> samples) {
+    if ((this->region_history().rows() != samples->values.rows()) ||
+        (this->region_names() != samples->regions->names())) {
+        this->region_history().reset(samples->values.rows());
+        this->region_names() = samples->regions->names();
+    }
+    for (mpFlow::dtype::index column = 0; column < samples->values.cols(); ++column) {
+        this->region_history().push(samples->first_id + column, samples->timestamps(column),
+            samples->values.col(column));
+    }
+}
+
+void MirrorServer::enqueue(Subscriber& subscriber, const QueuedFrame& frame, bool keyframe) {
+    // delta frames are useless without their predecessor, so skip them until next keyframe
+    if (subscriber.needs_keyframe && !keyframe) {
+        subscriber.dropped_frames += 1;
+        return;
+    }
+    subscriber.needs_keyframe = false;
+    subscriber.queue.push_back(frame);
+
+    // slow clients only get the latest frames, memory per client stays bounded
+    if (subscriber.queue.size() > this->max_queued_frames()) {
+        if (subscriber.encoder->delta()) {
+            subscriber.dropped_frames += subscriber.queue.size();
+            subscriber.queue.clear();
+            subscriber.needs_keyframe = true;
+        } else {
+            subscriber.dropped_frames += 1;
+            subscriber.queue.pop_front();
+        }
+    }
+
+    this->send_next(subscriber);
+}
+
+void MirrorServer::send_next(Subscriber& subscriber) {
+    // only one frame is handed to the socket at once, next one follows, when it is written
+    if (subscriber.writing || subscriber.queue.empty()) {
+        return;
+    }
+
+    const auto& frame = subscriber.queue.front();
+    subscriber.writing = true;
+    subscriber.last_frame_id = frame.frame_id;
+    subscriber.sent_frames += 1;
+    subscriber.bytes_sent += frame.message.size();
+    subscriber.response->write(frame.message);
+
+    // time from presentation until frame is handed to the socket of this client
+    if (this->latency_tracer() != nullptr) {
+        this->latency_tracer()->record(LatencyTracer::mirror_send,
+            HighPrecisionTime::now() - frame.presentation_time);
+    }
+    subscriber.queue.pop_front();
+}
+
+Eigen::ArrayXXf MirrorServer::expanded_vertices(const MirrorMesh& mesh, const MirrorFrame& frame) {
+    Eigen::ArrayXXf vertices(3 * 3, mesh.elements.rows());
+    for (mpFlow::dtype::index element = 0; element < mesh.elements.rows(); ++element)
+    for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+        vertices(node * 3 + 0, element) = mesh.nodes(0, mesh.elements(element, node));
+        vertices(node * 3 + 1, element) = mesh.nodes(1, mesh.elements(element, node));
+        vertices(node * 3 + 2, element) = 1.0 - 2.0 * frame.z_values()(mesh.elements(element, node));
+    }
+
+    return vertices;
+}
+
+Eigen::ArrayXXf MirrorServer::expanded_colors(const MirrorMesh& mesh, const MirrorFrame& frame) {
+    Eigen::ArrayXXf colors(3 * 3, mesh.elements.rows());
+    if (frame.interpolate_colors) {
+        Eigen::ArrayXXf node_colors = colormap::jet(frame.z_values());
+        for (mpFlow::dtype::index element = 0; element < mesh.elements.rows(); ++element)
+        for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+            colors.block(node * 3, element, 3, 1) =
+                node_colors.row(mesh.elements(element, node)).transpose();
+        }
+    } else {
+        Eigen::ArrayXXf element_colors = colormap::jet(
+            frame.element_values().head(mesh.elements.rows())).transpose();
+        colors.middleRows(0, 3) = colors.middleRows(3, 3) = colors.middleRows(6, 3) = element_colors;
+    }
+
+    return colors;
+}
+
+void MirrorServer::handleElectrodesConfigRequest(QHttpRequest* request, QHttpResponse *response) {
+    this->respond(request, response, this->mesh_tag(), [=]() {
+        QByteArray vertices((const char*)this->mesh()->electrodes.data(),
+            sizeof(float) * this->mesh()->electrodes.rows() * this->mesh()->electrodes.cols());
+        QByteArray colors = QByteArray::fromRawData((const char*)this->mesh()->electrode_colors.data(),
+            sizeof(float) * this->mesh()->electrode_colors.rows() * this->mesh()->electrode_colors.cols());
+        return vertices.append(colors);
+    });
+}
+
+void MirrorServer::handleVerticesConfigRequest(QHttpRequest* request, QHttpResponse *response) {
+    this->respond(request, response, this->frame_tag(), [=]() {
+        Eigen::ArrayXXf expandedVertices = MirrorServer::expanded_vertices(*this->mesh(), *this->frame());
+        return QByteArray((const char*)expandedVertices.data(),
+            sizeof(float) * expandedVertices.rows() * expandedVertices.cols());
+    });
+}
+
+void MirrorServer::handleVerticesUpdateRequest(QHttpRequest* request, QHttpResponse *response) {
+    this->respond(request, response, this->frame_tag(), [=]() {
+        Eigen::ArrayXXf expandedVertices = MirrorServer::expanded_vertices(*this->mesh(), *this->frame());
+        Eigen::ArrayXXf vertices = Eigen::ArrayXXf::Zero(3, expandedVertices.cols());
+        vertices.row(0) = expandedVertices.row(2 + 0 * 3);
+        vertices.row(1) = expandedVertices.row(2 + 1 * 3);
+        vertices.row(2) = expandedVertices.row(2 + 2 * 3);
+        return QByteArray((const char*)vertices.data(),
+            sizeof(float) * vertices.rows() * vertices.cols());
+    });
+}
+
+void MirrorServer::handleColorConfigRequest(QHttpRequest* request, QHttpResponse *response) {
+    this->respond(request, response, this->frame_tag(), [=]() {
+        Eigen::ArrayXXf expandedColors = MirrorServer::expanded_colors(*this->mesh(), *this->frame());
+        return QByteArray((const char*)expandedColors.data(),
+            sizeof(float) * expandedColors.rows() * expandedColors.cols());
+    });
+}
+
+void MirrorServer::handleColorUpdateRequest(QHttpRequest* request, QHttpResponse* response){
+    this->respond(request, response, this->frame_tag(), [=]() {
+        Eigen::ArrayXXf colors = MirrorServer::expanded_colors(*this->mesh(), *this->frame()).topRows(3);
+        return QByteArray((const char*)colors.data(),
+            sizeof(float) * colors.rows() * colors.cols());
+    });
+}
+
+void MirrorServer::handleAnalysisUpdateRequest(QHttpRequest* request, QHttpResponse *response) {
+    this->respond(request, response, this->analysis_tag(), [=]() {
+        QVariantMap map;
+        map["analysis"] = this->analysis();
+
+        QJsonObject json = QJsonObject::fromVariantMap(map);
+        QJsonDocument jsonDocument(json);
+        return jsonDocument.toJson();
+    });
+}
+
+void MirrorServer::handleCalibrateRequest(QHttpResponse *response) {
+    Q_UNUSED(response);
+
+    emit this->calibrate();
+}
+
+void MirrorServer::handleMeshRequest(QHttpRequest* request, QHttpResponse* response) {
+    // static mesh for compact stream clients: float nodes (2 x N) followed by
+    // uint32 node indices of all elements (3 x M)
+    this->respond(request, response, this->mesh_tag(), [=]() {
+        Eigen::Array<quint32, Eigen::Dynamic, Eigen::Dynamic> elements =
+            this->mesh()->elements.transpose().cast<quint32>();
+        QByteArray body((const char*)this->mesh()->nodes.data(),
+            sizeof(float) * this->mesh()->nodes.size());
+        return body.append((const char*)elements.data(), sizeof(quint32) * elements.size());
+    });
+}
+
+void MirrorServer::handleStatsRequest(QHttpResponse* response) {
+    QJsonObject cache;
+    cache["hits"] = (double)this->cache_hits();
+    cache["misses"] = (double)this->cache_misses();
+    cache["not_modified"] = (double)this->not_modified();
+    cache["hit_rate"] = (this->cache_hits() + this->cache_misses()) > 0 ?
+        (double)this->cache_hits() / (this->cache_hits() + this->cache_misses()) : 0.0;
+
+    // lag is the number of presented frames the client is behind
+    quint64 frame_id = this->frame() ? this->frame()->frame_id : 0;
+    QJsonArray subscribers;
+    for (const auto& subscriber : this->subscribers()) {
+        QJsonObject stats;
+        stats["format"] = (double)subscriber->encoder->format();
+        stats["delta"] = subscriber->encoder->delta();
+        stats["sent_frames"] = (double)subscriber->sent_frames;
+        stats["dropped_frames"] = (double)subscriber->dropped_frames;
+        stats["queued_frames"] = (double)subscriber->queue.size();
+        stats["bytes_sent"] = (double)subscriber->bytes_sent;
+        stats["lag"] = (double)(frame_id > subscriber->last_frame_id ?
+            frame_id - subscriber->last_frame_id : 0);
+        subscribers.append(stats);
+    }
+
+    QJsonObject json;
+    json["cache"] = cache;
+    json["subscribers"] = subscribers;
+    json["rejected_subscribers"] = (double)this->rejected_subscribers();
+    json["frame_id"] = (double)frame_id;
+    json["history_frames"] = (double)this->history().size();
+    QByteArray body = QJsonDocument(json).toJson();
+
+    response->setHeader("Content-Type", "application/json");
+    response->setHeader("Content-Length", QString::number(body.length()));
     response->writeHead(200);
-    response->end(verticesByteArray);
+    response->end(body);
 }
 
-void MirrorServer::handleColorConfigRequest(QHttpResponse *response) {
-    // fill dictionary with config data
-    QByteArray colors = QByteArray::fromRawData((const char*)this->image()->colors().data(),
-        sizeof(float) * this->image()->colors().rows() * this->image()->colors().cols());
+void MirrorServer::handleLatencyRequest(QHttpRequest* request, QHttpResponse* response) {
+    // per stage latency percentiles, complete histograms via ?buckets=1
+    if (this->latency_tracer() == nullptr) {
+        response->writeHead(503);
+        response->end();
+        return;
+    }
+    QUrlQuery query(request->url());
+    QByteArray body = QJsonDocument(this->latency_tracer()->to_json(
+        query.queryItemValue("buckets") == "1")).toJson();
 
-    response->setHeader("Content-Length", QString::number(colors.length()));
+    response->setHeader("Content-Type", "application/json");
+    response->setHeader("Content-Length", QString::number(body.length()));
     response->writeHead(200);
-    response->end(colors);
+    response->end(body);
 }
 
-void MirrorServer::handleColorUpdateRequest(QHttpResponse* response){
-    // fill dictionary with config data
-    Eigen::ArrayXXf colors = this->image()->colors().block(0, 0, 3, this->image()->colors().cols()).eval();
-    QByteArray colorsByteArray = QByteArray::fromRawData((const char*)colors.data(),
-        sizeof(float) * colors.rows() * colors.cols());
+void MirrorServer::handleTraceRequest(QHttpResponse* response) {
+    // profiler zones of all threads as chrome trace
+    QByteArray body = Profiler::chrome_trace();
 
-    response->setHeader("Content-Length", QString::number(colorsByteArray.length()));
+    response->setHeader("Content-Type", "application/json");
+    response->setHeader("Content-Length", QString::number(body.length()));
     response->writeHead(200);
-    response->end(colorsByteArray);
+    response->end(body);
 }
 
-void MirrorServer::handleAnalysisUpdateRequest(QHttpResponse *response) {
-    QVariantList list;
-    for (const auto& analysis : this->analysis()) {
-        QVariantMap analysisMap;
-        analysisMap["name"] = std::get<0>(analysis);
-        analysisMap["result"] = std::get<1>(analysis);
-        list.append(analysisMap);
+void MirrorServer::handleStreamRequest(QHttpRequest* request, QHttpResponse* response) {
+    // stream format is float by default, compact formats are opt-in via
+    // ?format=u8 or ?format=u16 and can be delta coded via &delta=1
+    QUrlQuery query(request->url());
+    QString format = query.queryItemValue("format");
+    MirrorEncoder::Format encoding = MirrorEncoder::float32;
+    if (format == "u8") {
+        encoding = MirrorEncoder::uint8;
+    }
+    else if (format == "u16") {
+        encoding = MirrorEncoder::uint16;
+    }
+    else if (!format.isEmpty() && (format != "f32")) {
+        response->writeHead(400);
+        response->end();
+        return;
+    }
+    bool delta = (encoding != MirrorEncoder::float32) && (query.queryItemValue("delta") == "1");
+
+    // limit number of stream connections
+    if (this->subscribers().size() >= this->max_subscribers()) {
+        this->rejected_subscribers() += 1;
+        response->writeHead(503);
+        response->end();
+        return;
+    }
+
+    // share encoder with all clients of same format, delta clients start with a keyframe of their own
+    auto key = std::make_pair((int)encoding, delta);
+    if (this->encoders().find(key) == this->encoders().end()) {
+        this->encoders()[key] = std::unique_ptr<MirrorEncoder>(new MirrorEncoder(encoding, delta));
     }
+    MirrorEncoder* encoder = this->encoders()[key].get();
+
+    // keep response open without content length, so it is sent chunked
+    response->setHeader("Content-Type", "application/octet-stream");
+    response->setHeader("Cache-Control", "no-cache");
+    response->writeHead(200);
+
+    // send next queued frame, when socket is drained
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->response = response;
+    subscriber->encoder = encoder;
+    subscriber->keyframe_encoder = std::unique_ptr<MirrorEncoder>(new MirrorEncoder(encoding, delta));
+    subscriber->needs_keyframe = delta;
+    this->subscribers().push_back(subscriber);
+    std::weak_ptr<Subscriber> weak_subscriber = subscriber;
+    connect(response, &QHttpResponse::allBytesWritten, this, [=]() {
+        if (auto subscriber = weak_subscriber.lock()) {
+            subscriber->writing = false;
+            this->send_next(*subscriber);
+        }
+    });
 
-    QVariantMap map;
-    map["analysis"] = list;
+    // unsubscribe, when client disconnects, and drop encoders without clients
+    connect(response, &QHttpResponse::done, this, [=]() {
+        this->subscribers().erase(std::remove_if(this->subscribers().begin(),
+            this->subscribers().end(), [=](const std::shared_ptr<Subscriber>& subscriber) {
+                return subscriber->response == response;
+            }), this->subscribers().end());
+
+        if (std::none_of(this->subscribers().begin(), this->subscribers().end(),
+            [=](const std::shared_ptr<Subscriber>& subscriber) { return subscriber->encoder == encoder; })) {
+            this->encoders().erase(key);
+        }
+    });
+}
 
-    QJsonObject json = QJsonObject::fromVariantMap(map);
-    QJsonDocument jsonDocument(json);
-    QByteArray body = jsonDocument.toJson();
+void MirrorServer::handleFramesRequest(QHttpRequest* request, QHttpResponse* response) {
+    // all frames after given id in one batch, so clients catch up in a single round trip
+    QUrlQuery query(request->url());
+    QByteArray body = this->history().batch(query.queryItemValue("since").toULongLong());
 
+    response->setHeader("Content-Type", "application/octet-stream");
+    response->setHeader("Cache-Control", "no-cache");
     response->setHeader("Content-Length", QString::number(body.length()));
     response->writeHead(200);
     response->end(body);
 }
 
-void MirrorServer::handleCalibrateRequest(QHttpResponse *response) {
-    Q_UNUSED(response);
+void MirrorServer::handleRegionsRequest(QHttpRequest* request, QHttpResponse* response) {
+    // regional mean values of every analysed frame after given sample id,
+    // same batch layout as /frames with one value per region
+    QUrlQuery query(request->url());
+    QByteArray body = this->region_history().batch(query.queryItemValue("since").toULongLong());
 
-    emit this->calibrate();
+    response->setHeader("Content-Type", "application/octet-stream");
+    response->setHeader("Cache-Control", "no-cache");
+    response->setHeader("Content-Length", QString::number(body.length()));
+    response->writeHead(200);
+    response->end(body);
+}
+
+void MirrorServer::handleRegionNamesRequest(QHttpResponse* response) {
+    QJsonObject json;
+    json["regions"] = QJsonArray::fromStringList(this->region_names());
+    QByteArray body = QJsonDocument(json).toJson();
+
+    response->setHeader("Content-Type", "application/json");
+    response->setHeader("Content-Length", QString::number(body.length()));
+    response->writeHead(200);
+    response->end(body);
 }
@@ -2,16 +2,60 @@
 #define MIRRORSERVER_H
 
 #include <QObject>
+#include <QThread>
+#include <QVariantList>
 #include <qhttpserver.h>
 #include <qhttprequest.h>
 #include <qhttpresponse.h>
-#include "image.h"
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include "mirrorsnapshot.h"
+#include "mirrorprotocol.h"
+#include "mirrorencoder.h"
+#include "framehistory.h"
+#include "regionsofinterest.h"
+#include "latencytracer.h"
 
+// serves mirror clients from its own event loop thread, all data comes from
+// immutable snapshots published by the renderer and the main window
 class MirrorServer : public QObject {
     Q_OBJECT
 public:
-    explicit MirrorServer(Image* image, std::vector<std::tuple<QString, QString>>* analysis,
-                          QObject *parent = 0);
+    // encoded frame waiting for the socket to drain
+    struct QueuedFrame {
+        quint64 frame_id;
+        QByteArray message;
+        double presentation_time;
+    };
+
+    // stream client with its encoder, which is shared by all clients of same format,
+    // and a small queue of encoded frames waiting for the socket to drain
+    struct Subscriber {
+        QHttpResponse* response;
+        MirrorEncoder* encoder;
+        // codes keyframes for this client only, when it has to resynchronize
+        std::unique_ptr<MirrorEncoder> keyframe_encoder;
+        std::deque<QueuedFrame> queue;
+        bool writing = false;
+        bool needs_keyframe = false;
+        quint64 last_frame_id = 0;
+        quint64 sent_frames = 0;
+        quint64 dropped_frames = 0;
+        quint64 bytes_sent = 0;
+    };
+
+    // serialized response body of one endpoint, valid as long as its tag matches the current data
+    struct CacheEntry {
+        QByteArray tag;
+        QByteArray body;
+    };
+
+    explicit MirrorServer(quint16 port=3003, size_t max_subscribers=256,
+        size_t max_queued_frames=2, double history_duration=10.0,
+        size_t history_bytes=64 * 1024 * 1024, QObject *parent = 0);
 
 signals:
     void calibrate();
@@ -19,24 +63,90 @@ signals:
 public:
     void handleRequest(QHttpRequest* request, QHttpResponse* response);
 
+public slots:
+    void listen(quint16 port);
+    void update_mesh(std::shared_ptr<const MirrorMesh> mesh);
+    void update_analysis(QVariantList analysis);
+    void publish_frame(std::shared_ptr<const MirrorFrame> frame);
+    void update_history(std::shared_ptr<RenderFrames> frames, double time_elapsed);
+    void update_regions(std::shared_ptr<const RegionSamples> samples);
+
 protected:
-    void handleElectrodesConfigRequest(QHttpResponse* response);
-    void handleVerticesConfigRequest(QHttpResponse* response);
-    void handleVerticesUpdateRequest(QHttpResponse* response);
-    void handleColorConfigRequest(QHttpResponse* response);
-    void handleColorUpdateRequest(QHttpResponse* response);
-    void handleAnalysisUpdateRequest(QHttpResponse* response);
+    bool snapshot_ready();
+    void enqueue(Subscriber& subscriber, const QueuedFrame& frame, bool keyframe);
+    void send_next(Subscriber& subscriber);
+    void respond(QHttpRequest* request, QHttpResponse* response, const QByteArray& tag,
+        std::function<QByteArray()> serialize);
+    QByteArray mesh_tag();
+    QByteArray frame_tag();
+    QByteArray analysis_tag();
+    void handleElectrodesConfigRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleVerticesConfigRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleVerticesUpdateRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleColorConfigRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleColorUpdateRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleAnalysisUpdateRequest(QHttpRequest* request, QHttpResponse* response);
     void handleCalibrateRequest(QHttpResponse* response);
+    void handleMeshRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleStreamRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleStatsRequest(QHttpResponse* response);
+    void handleLatencyRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleTraceRequest(QHttpResponse* response);
+    void handleFramesRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleRegionsRequest(QHttpRequest* request, QHttpResponse* response);
+    void handleRegionNamesRequest(QHttpResponse* response);
+
+    // expanded per element vertex and color buffers of a frame
+    static Eigen::ArrayXXf expanded_vertices(const MirrorMesh& mesh, const MirrorFrame& frame);
+    static Eigen::ArrayXXf expanded_colors(const MirrorMesh& mesh, const MirrorFrame& frame);
 
 public:
     QHttpServer* httpServer() { return this->_httpServer; }
-    Image* image() { return this->_image; }
-    std::vector<std::tuple<QString, QString>>& analysis() { return *this->_analysis; }
+    QThread* thread() { return this->thread_; }
+    std::shared_ptr<const MirrorMesh>& mesh() { return this->mesh_; }
+    std::shared_ptr<const MirrorFrame>& frame() { return this->frame_; }
+    QVariantList& analysis() { return this->analysis_; }
+    QByteArray& instance_tag() { return this->instance_tag_; }
+    quint64& mesh_generation() { return this->mesh_generation_; }
+    quint64& analysis_generation() { return this->analysis_generation_; }
+    std::map<QString, CacheEntry>& cache() { return this->cache_; }
+    quint64& cache_hits() { return this->cache_hits_; }
+    quint64& cache_misses() { return this->cache_misses_; }
+    quint64& not_modified() { return this->not_modified_; }
+    std::vector<std::shared_ptr<Subscriber>>& subscribers() { return this->subscribers_; }
+    size_t max_subscribers() { return this->max_subscribers_; }
+    size_t max_queued_frames() { return this->max_queued_frames_; }
+    quint64& rejected_subscribers() { return this->rejected_subscribers_; }
+    FrameHistory& history() { return this->history_; }
+    quint64& history_frame_id() { return this->history_frame_id_; }
+    FrameHistory& region_history() { return this->region_history_; }
+    QStringList& region_names() { return this->region_names_; }
+    std::map<std::pair<int, bool>, std::unique_ptr<MirrorEncoder>>& encoders() { return this->encoders_; }
+    std::shared_ptr<LatencyTracer>& latency_tracer() { return this->latency_tracer_; }
 
 private:
     QHttpServer* _httpServer;
-    Image* _image;
-    std::vector<std::tuple<QString, QString>>* _analysis;
+    QThread* thread_;
+    std::shared_ptr<const MirrorMesh> mesh_;
+    std::shared_ptr<const MirrorFrame> frame_;
+    QVariantList analysis_;
+    QByteArray instance_tag_;
+    quint64 mesh_generation_;
+    quint64 analysis_generation_;
+    std::map<QString, CacheEntry> cache_;
+    quint64 cache_hits_;
+    quint64 cache_misses_;
+    quint64 not_modified_;
+    std::vector<std::shared_ptr<Subscriber>> subscribers_;
+    size_t max_subscribers_;
+    size_t max_queued_frames_;
+    quint64 rejected_subscribers_;
+    FrameHistory history_;
+    quint64 history_frame_id_;
+    FrameHistory region_history_;
+    QStringList region_names_;
+    std::map<std::pair<int, bool>, std::unique_ptr<MirrorEncoder>> encoders_;
+    std::shared_ptr<LatencyTracer> latency_tracer_;
 };
 
 #endif // MIRRORSERVER_H
@@ -0,0 +1,38 @@
+#ifndef MIRRORSNAPSHOT_H
+#define MIRRORSNAPSHOT_H
+
+#include <memory>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+#include "renderpreparer.h"
+
+// immutable snapshots published by the renderer to the mirror server thread,
+// both are shared read only, so a response never mixes data of two frames
+
+// display mesh set by Image::init, empty after Image::cleanup
+struct MirrorMesh {
+    Eigen::ArrayXXf nodes;
+    Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic> elements;
+    Eigen::ArrayXXf electrodes;
+    Eigen::ArrayXXf electrode_colors;
+};
+
+// presented frame, references the prepared buffers of its batch instead of copying them
+struct MirrorFrame {
+    quint64 frame_id;
+    std::shared_ptr<const RenderFrames> frames;
+    mpFlow::dtype::index column;
+    bool interpolate_colors;
+    double presentation_time;
+
+    Eigen::ArrayXXf::ConstColXpr z_values() const { return this->frames->z_values.col(this->column); }
+    Eigen::ArrayXXf::ConstColXpr element_values() const { return this->frames->element_values.col(this->column); }
+
+    // frames in flight while the mesh changes do not match the new mesh
+    bool matches(const MirrorMesh& mesh) const {
+        return (this->frames->z_values.rows() == mesh.nodes.cols()) &&
+            (this->frames->element_values.rows() >= mesh.elements.rows());
+    }
+};
+
+#endif // MIRRORSNAPSHOT_H
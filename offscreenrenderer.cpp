@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "offscreenrenderer.h"
+#include "renderpreparer.h"
+#include "colormap.h"
+
+OffscreenRenderer::OffscreenRenderer(const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::SparseMatrix<float, Eigen::RowMajor>& node_averaging,
+    const Eigen::ArrayXXf& electrodes, const Eigen::ArrayXXf& electrode_colors,
+    mpFlow::dtype::real sigma_ref) :
+    nodes_(nodes), elements_(elements), node_averaging_(node_averaging),
+    electrodes_(electrodes), electrode_colors_(electrode_colors), sigma_ref_(sigma_ref),
+    threashold_(0.02), draw_wireframe_(false), interpolate_colors_(false), supersampling_(2) {
+    this->view_angle()[0] = 0.0;
+    this->view_angle()[1] = 0.0;
+
+    // sample jet colormap to packed rgb values
+    Eigen::ArrayXXf table = colormap::jet_table();
+    this->colormap().resize(colormap::table_size);
+    for (int i = 0; i < colormap::table_size; ++i) {
+        this->colormap()[i] = qRgb(table(0, i) * 255.0, table(1, i) * 255.0, table(2, i) * 255.0);
+    }
+}
+
+QImage OffscreenRenderer::render(const Eigen::Ref<const Eigen::ArrayXXf>& data, int size) {
+    // normalize frame and calc z values the same way as for the gpu renderer
+    Eigen::ArrayXXf element_values(data.rows(), 1);
+    Eigen::ArrayXXf z_values(this->node_averaging().rows(), 1);
+    RenderPreparer::prepare(data.col(0), this->node_averaging(), this->sigma_ref(),
+        this->threashold(), element_values, z_values);
+
+    // create supersampled canvas
+    int canvas_size = size * this->supersampling();
+    Canvas canvas;
+    canvas.image = QImage(canvas_size, canvas_size, QImage::Format_RGB32);
+    canvas.image.fill(Qt::white);
+    canvas.depth.assign(canvas_size * canvas_size, std::numeric_limits<float>::max());
+
+    // rotation matching glRotatef calls of Image::paintGL
+    float cos_x = std::cos(this->view_angle()[0] * M_PI / 180.0);
+    float sin_x = std::sin(this->view_angle()[0] * M_PI / 180.0);
+    float cos_z = std::cos(this->view_angle()[1] * M_PI / 180.0);
+    float sin_z = std::sin(this->view_angle()[1] * M_PI / 180.0);
+    auto project = [=](float x, float y, float z) -> Eigen::Vector3f {
+        float rx = x * cos_z - y * sin_z;
+        float ry = x * sin_z + y * cos_z;
+        float py = ry * cos_x - z * sin_x;
+        float pz = ry * sin_x + z * cos_x;
+
+        // orthographic projection to canvas coordinates, depth grows away from viewer
+        return Eigen::Vector3f((0.5 * rx + 0.5) * canvas_size,
+            (0.5 - 0.5 * py) * canvas_size, pz);
+    };
+
+    // transform all nodes once
+    std::vector<Eigen::Vector3f> points(this->nodes().cols());
+    for (mpFlow::dtype::index node = 0; node < this->nodes().cols(); ++node) {
+        points[node] = project(this->nodes()(0, node), this->nodes()(1, node),
+            1.0 - 2.0 * z_values(node, 0));
+    }
+
+    // draw mesh
+    for (mpFlow::dtype::index element = 0; element < this->elements().rows(); ++element) {
+        std::array<Eigen::Vector3f, 3> triangle;
+        std::array<float, 3> values;
+        for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+            triangle[node] = points[this->elements()(element, node)];
+            values[node] = this->interpolate_colors() ?
+                z_values(this->elements()(element, node), 0) : element_values(element, 0);
+        }
+        this->fill_triangle(canvas, triangle, values);
+    }
+
+    // draw wireframes slightly in front of mesh surface
+    if (this->draw_wireframe()) {
+        for (mpFlow::dtype::index element = 0; element < this->elements().rows(); ++element)
+        for (mpFlow::dtype::index node = 0; node < 3; ++node) {
+            this->draw_line(canvas, points[this->elements()(element, node)],
+                points[this->elements()(element, (node + 1) % 3)], qRgb(0, 0, 0),
+                1.5 * this->supersampling(), 1e-2);
+        }
+    }
+
+    // draw electrodes
+    for (mpFlow::dtype::index electrode = 0; electrode < this->electrodes().cols(); ++electrode) {
+        this->draw_line(canvas,
+            project(this->electrodes()(0, electrode), this->electrodes()(1, electrode), 0.0),
+            project(this->electrodes()(2, electrode), this->electrodes()(3, electrode), 0.0),
+            qRgb(this->electrode_colors()(0, electrode) * 255.0,
+                this->electrode_colors()(1, electrode) * 255.0,
+                this->electrode_colors()(2, electrode) * 255.0),
+            3.0 * this->supersampling(), 0.0);
+    }
+
+    // downsample to antialias edges
+    if (this->supersampling() > 1) {
+        return canvas.image.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    return canvas.image;
+}
+
+void OffscreenRenderer::fill_triangle(Canvas& canvas, const std::array<Eigen::Vector3f, 3>& points,
+    const std::array<float, 3>& values) {
+    // signed doubled area, degenerated triangles are skipped
+    float area = (points[1](0) - points[0](0)) * (points[2](1) - points[0](1)) -
+        (points[2](0) - points[0](0)) * (points[1](1) - points[0](1));
+    if (std::abs(area) < 1e-12) {
+        return;
+    }
+
+    // bounding box clipped to canvas
+    int width = canvas.image.width();
+    int height = canvas.image.height();
+    int min_x = std::max(0, (int)std::floor(std::min({ points[0](0), points[1](0), points[2](0) })));
+    int max_x = std::min(width - 1, (int)std::ceil(std::max({ points[0](0), points[1](0), points[2](0) })));
+    int min_y = std::max(0, (int)std::floor(std::min({ points[0](1), points[1](1), points[2](1) })));
+    int max_y = std::min(height - 1, (int)std::ceil(std::max({ points[0](1), points[1](1), points[2](1) })));
+
+    // rasterize with barycentric coordinates at pixel centers
+    for (int y = min_y; y <= max_y; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(canvas.image.scanLine(y));
+        float* depth = &canvas.depth[y * width];
+        for (int x = min_x; x <= max_x; ++x) {
+            float px = x + 0.5, py = y + 0.5;
+            float w0 = ((points[1](0) - px) * (points[2](1) - py) -
+                (points[2](0) - px) * (points[1](1) - py)) / area;
+            float w1 = ((points[2](0) - px) * (points[0](1) - py) -
+                (points[0](0) - px) * (points[2](1) - py)) / area;
+            float w2 = 1.0 - w0 - w1;
+            if ((w0 < 0.0) || (w1 < 0.0) || (w2 < 0.0)) {
+                continue;
+            }
+
+            float z = w0 * points[0](2) + w1 * points[1](2) + w2 * points[2](2);
+            if (z > depth[x]) {
+                continue;
+            }
+            depth[x] = z;
+
+            float value = w0 * values[0] + w1 * values[1] + w2 * values[2];
+            int index = std::min(std::max((int)(value * (colormap::table_size - 1) + 0.5), 0),
+                colormap::table_size - 1);
+            line[x] = this->colormap()[index];
+        }
+    }
+}
+
+void OffscreenRenderer::draw_line(Canvas& canvas, const Eigen::Vector3f& start,
+    const Eigen::Vector3f& end, QRgb color, float width, float depth_bias) {
+    int canvas_width = canvas.image.width();
+    int canvas_height = canvas.image.height();
+    int half_width = std::max(0, (int)(0.5 * width));
+
+    // step along line and stamp square pens of given width
+    int steps = std::max(1, (int)std::ceil(std::max(std::abs(end(0) - start(0)),
+        std::abs(end(1) - start(1)))));
+    for (int step = 0; step <= steps; ++step) {
+        Eigen::Vector3f point = start + (end - start) * ((float)step / steps);
+        for (int y = (int)point(1) - half_width; y <= (int)point(1) + half_width; ++y)
+        for (int x = (int)point(0) - half_width; x <= (int)point(0) + half_width; ++x) {
+            if ((x < 0) || (y < 0) || (x >= canvas_width) || (y >= canvas_height)) {
+                continue;
+            }
+
+            float& depth = canvas.depth[y * canvas_width + x];
+            if (point(2) - depth_bias <= depth) {
+                depth = point(2) - depth_bias;
+                reinterpret_cast<QRgb*>(canvas.image.scanLine(y))[x] = color;
+            }
+        }
+    }
+}
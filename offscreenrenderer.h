@@ -0,0 +1,63 @@
+#ifndef OFFSCREENRENDERER_H
+#define OFFSCREENRENDERER_H
+
+#include <QImage>
+#include <array>
+#include <vector>
+#include <Eigen/Sparse>
+#include <mpflow/mpflow.h>
+
+// software renderer of the mesh visualization of Image, which needs
+// neither a display nor a gpu and can be used from several threads at once
+class OffscreenRenderer {
+public:
+    OffscreenRenderer(const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::SparseMatrix<float, Eigen::RowMajor>& node_averaging,
+        const Eigen::ArrayXXf& electrodes, const Eigen::ArrayXXf& electrode_colors,
+        mpFlow::dtype::real sigma_ref);
+
+    QImage render(const Eigen::Ref<const Eigen::ArrayXXf>& data, int size);
+
+protected:
+    struct Canvas {
+        QImage image;
+        std::vector<float> depth;
+    };
+
+    void fill_triangle(Canvas& canvas, const std::array<Eigen::Vector3f, 3>& points,
+        const std::array<float, 3>& values);
+    void draw_line(Canvas& canvas, const Eigen::Vector3f& start, const Eigen::Vector3f& end,
+        QRgb color, float width, float depth_bias);
+
+public:
+    // accessors
+    Eigen::ArrayXXf& nodes() { return this->nodes_; }
+    Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements() { return this->elements_; }
+    Eigen::SparseMatrix<float, Eigen::RowMajor>& node_averaging() { return this->node_averaging_; }
+    Eigen::ArrayXXf& electrodes() { return this->electrodes_; }
+    Eigen::ArrayXXf& electrode_colors() { return this->electrode_colors_; }
+    std::vector<QRgb>& colormap() { return this->colormap_; }
+    mpFlow::dtype::real& sigma_ref() { return this->sigma_ref_; }
+    std::array<mpFlow::dtype::real, 2>& view_angle() { return this->view_angle_; }
+    mpFlow::dtype::real& threashold() { return this->threashold_; }
+    bool& draw_wireframe() { return this->draw_wireframe_; }
+    bool& interpolate_colors() { return this->interpolate_colors_; }
+    int& supersampling() { return this->supersampling_; }
+
+private:
+    Eigen::ArrayXXf nodes_;
+    Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic> elements_;
+    Eigen::SparseMatrix<float, Eigen::RowMajor> node_averaging_;
+    Eigen::ArrayXXf electrodes_;
+    Eigen::ArrayXXf electrode_colors_;
+    std::vector<QRgb> colormap_;
+    mpFlow::dtype::real sigma_ref_;
+    std::array<mpFlow::dtype::real, 2> view_angle_;
+    mpFlow::dtype::real threashold_;
+    bool draw_wireframe_;
+    bool interpolate_colors_;
+    int supersampling_;
+};
+
+#endif // OFFSCREENRENDERER_H
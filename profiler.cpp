@@ -0,0 +1,165 @@
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+#include "profiler.h"
+
+std::atomic<bool> Profiler::enabled_(true);
+std::mutex Profiler::mutex_;
+std::vector<Profiler::ThreadBuffer*> Profiler::buffers_;
+
+// appends string as quoted json string, names may contain any characters
+static void append_json_string(QByteArray& json, const char* string) {
+    static const char hex[] = "0123456789abcdef";
+    json.append('"');
+    for (const char* c = string; *c != 0; ++c) {
+        if ((*c == '"') || (*c == '\\')) {
+            json.append('\\');
+            json.append(*c);
+        } else if ((unsigned char)*c < 0x20) {
+            json.append("\\u00");
+            json.append(hex[(*c >> 4) & 0xf]);
+            json.append(hex[*c & 0xf]);
+        } else {
+            json.append(*c);
+        }
+    }
+    json.append('"');
+}
+
+// hands buffer back for reuse, when its thread finishes
+struct ThreadBufferOwner {
+    Profiler::ThreadBuffer* buffer = nullptr;
+    ~ThreadBufferOwner() {
+        if (this->buffer != nullptr) {
+            this->buffer->active.store(false, std::memory_order_release);
+        }
+    }
+};
+
+void Profiler::set_enabled(bool enabled) {
+    Profiler::enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::set_thread_name(const char* name) {
+    ThreadBuffer* buffer = Profiler::thread_buffer();
+
+    std::lock_guard<std::mutex> lock(Profiler::mutex_);
+    std::strncpy(buffer->thread_name, name, sizeof(buffer->thread_name) - 1);
+}
+
+Profiler::ThreadBuffer* Profiler::thread_buffer() {
+    static thread_local ThreadBufferOwner owner;
+    if (owner.buffer != nullptr) {
+        return owner.buffer;
+    }
+
+    // only first zone of each thread takes the lock and may allocate
+    std::lock_guard<std::mutex> lock(Profiler::mutex_);
+    ThreadBuffer* buffer = nullptr;
+    for (auto candidate : Profiler::buffers_) {
+        if (!candidate->active.load(std::memory_order_acquire)) {
+            buffer = candidate;
+            break;
+        }
+    }
+    if (buffer == nullptr) {
+        buffer = new ThreadBuffer();
+        buffer->thread_id = Profiler::buffers_.size() + 1;
+        Profiler::buffers_.push_back(buffer);
+    }
+    buffer->written.store(0, std::memory_order_relaxed);
+    buffer->exported_from = 0;
+    buffer->active.store(true, std::memory_order_relaxed);
+
+    // qt threads are named by their owners, others fall back to their number
+    std::memset(buffer->thread_name, 0, sizeof(buffer->thread_name));
+    QByteArray name = QThread::currentThread() ?
+        QThread::currentThread()->objectName().toLatin1() : QByteArray();
+    if (name.isEmpty()) {
+        name = "thread " + QByteArray::number(buffer->thread_id);
+    }
+    std::strncpy(buffer->thread_name, name.constData(), sizeof(buffer->thread_name) - 1);
+
+    owner.buffer = buffer;
+    return buffer;
+}
+
+void Profiler::record(const char* name, qint64 start, qint64 duration) {
+    ThreadBuffer* buffer = Profiler::thread_buffer();
+
+    // event is published by the release store of write position, the fence
+    // keeps overwriting a slot from becoming visible before the previous position
+    quint64 position = buffer->written.load(std::memory_order_relaxed);
+    Event& event = buffer->events[position % ThreadBuffer::capacity];
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    buffer->written.store(position + 1, std::memory_order_release);
+}
+
+QByteArray Profiler::chrome_trace() {
+    std::lock_guard<std::mutex> lock(Profiler::mutex_);
+
+    QByteArray trace;
+    trace.reserve(1024 * 1024);
+    trace.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    struct Copy {
+        const char* name;
+        qint64 start;
+        qint64 duration;
+    };
+    std::vector<Copy> events;
+    for (auto buffer : Profiler::buffers_) {
+        // copy events without stopping the writer, events overwritten while
+        // copying are dropped by comparing with write position afterwards
+        quint64 end = buffer->written.load(std::memory_order_acquire);
+        quint64 begin = std::max(buffer->exported_from,
+            end > ThreadBuffer::capacity ? end - ThreadBuffer::capacity : 0);
+        events.clear();
+        for (quint64 position = begin; position < end; ++position) {
+            const Event& event = buffer->events[position % ThreadBuffer::capacity];
+            events.push_back({ event.name.load(std::memory_order_relaxed),
+                event.start.load(std::memory_order_relaxed),
+                event.duration.load(std::memory_order_relaxed) });
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        quint64 overwritten = buffer->written.load(std::memory_order_relaxed);
+        size_t valid_begin = overwritten >= begin + ThreadBuffer::capacity ?
+            std::min((size_t)(overwritten - begin - ThreadBuffer::capacity + 1), events.size()) : 0;
+
+        // thread names are metadata events
+        trace.append(first ? "" : ",");
+        first = false;
+        trace.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        trace.append(QByteArray::number(buffer->thread_id));
+        trace.append(",\"args\":{\"name\":");
+        append_json_string(trace, buffer->thread_name);
+        trace.append("}}");
+
+        // complete events with time stamps in microseconds
+        for (size_t i = valid_begin; i < events.size(); ++i) {
+            trace.append(",{\"name\":");
+            append_json_string(trace, events[i].name);
+            trace.append(",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            trace.append(QByteArray::number(buffer->thread_id));
+            trace.append(",\"ts\":");
+            trace.append(QByteArray::number(events[i].start * 1e-3, 'f', 3));
+            trace.append(",\"dur\":");
+            trace.append(QByteArray::number(events[i].duration * 1e-3, 'f', 3));
+            trace.append("}");
+        }
+    }
+    trace.append("]}");
+
+    return trace;
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(Profiler::mutex_);
+
+    for (auto buffer : Profiler::buffers_) {
+        buffer->exported_from = buffer->written.load(std::memory_order_acquire);
+    }
+}
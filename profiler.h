@@ -0,0 +1,79 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QByteArray>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "highprecisiontime.h"
+
+// low overhead profiler for named zones of hot paths, each thread records
+// completed zones into its own preallocated ring buffer without any locks,
+// buffers are only read, when a trace is exported, so it can stay enabled
+// in production, zone names have to be string literals
+class Profiler {
+public:
+    // fields are atomic, so exporting while the owning thread overwrites an
+    // event is no data race, torn events are detected by the write position
+    struct Event {
+        std::atomic<const char*> name;
+        std::atomic<qint64> start;
+        std::atomic<qint64> duration;
+    };
+
+    // single producer ring buffer of one thread, oldest events are overwritten,
+    // buffers of finished threads are kept for export until a new thread reuses them
+    struct ThreadBuffer {
+        static const size_t capacity = 1 << 15;
+        std::array<Event, capacity> events;
+        std::atomic<quint64> written;
+        quint64 exported_from;
+        std::atomic<bool> active;
+        int thread_id;
+        char thread_name[32];
+    };
+
+    static bool enabled() { return Profiler::enabled_.load(std::memory_order_relaxed); }
+    static void set_enabled(bool enabled);
+    static void set_thread_name(const char* name);
+    static void record(const char* name, qint64 start, qint64 duration);
+
+    // all buffered events in chrome trace event format, which perfetto opens as well
+    static QByteArray chrome_trace();
+    static void clear();
+
+protected:
+    static ThreadBuffer* thread_buffer();
+
+private:
+    static std::atomic<bool> enabled_;
+    static std::mutex mutex_;
+    static std::vector<ThreadBuffer*> buffers_;
+};
+
+// records lifetime of a scope as profiler zone
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) : name_(name),
+        start_(Profiler::enabled() ? HighPrecisionTime::ticks() : 0) {
+    }
+    ~ProfileZone() {
+        if (this->start_ != 0) {
+            Profiler::record(this->name_, this->start_, HighPrecisionTime::ticks() - this->start_);
+        }
+    }
+
+private:
+    ProfileZone(const ProfileZone&);
+    ProfileZone& operator=(const ProfileZone&);
+
+    const char* name_;
+    qint64 start_;
+};
+
+#define PROFILE_ZONE_CONCAT_(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)(name)
+
+#endif // PROFILER_H
@@ -0,0 +1,90 @@
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+#include <limits>
+#include "regionplot.h"
+
+// curve colors, cycled for more regions
+static const QColor region_colors[] = {
+    Qt::black, Qt::red, Qt::blue, Qt::darkGreen, Qt::magenta,
+    Qt::darkYellow, Qt::darkCyan, Qt::darkRed, Qt::darkBlue
+};
+
+RegionPlot::RegionPlot(double duration, QWidget* parent) :
+    QWidget(parent), history_(duration, 16 * 1024 * 1024) {
+    this->setMinimumSize(200, 120);
+}
+
+void RegionPlot::add_samples(std::shared_ptr<const RegionSamples> samples) {
+    if (this->history().rows() != samples->values.rows()) {
+        this->history().reset(samples->values.rows());
+        this->names() = samples->regions->names();
+    }
+    for (mpFlow::dtype::index column = 0; column < samples->values.cols(); ++column) {
+        this->history().push(samples->first_id + column, samples->timestamps(column),
+            samples->values.col(column));
+    }
+
+    // repaints of many batches are merged by qt
+    this->update();
+}
+
+void RegionPlot::clear() {
+    this->history().reset(0);
+    this->names().clear();
+    this->update();
+}
+
+void RegionPlot::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(this->rect(), Qt::white);
+    if (this->history().size() < 2) {
+        return;
+    }
+
+    // scale time axis to history duration and value axis to visible range
+    qint64 last = this->history().timestamps()(this->history().slot(this->history().size() - 1));
+    qint64 first = last - (qint64)(this->history().duration() * 1e3);
+    float min = std::numeric_limits<float>::max(), max = std::numeric_limits<float>::lowest();
+    for (mpFlow::dtype::index position = 0; position < this->history().size(); ++position) {
+        min = std::min(min, this->history().values().col(this->history().slot(position)).minCoeff());
+        max = std::max(max, this->history().values().col(this->history().slot(position)).maxCoeff());
+    }
+    if (max - min < 1e-12) {
+        max += 1e-6;
+        min -= 1e-6;
+    }
+    QRectF area = QRectF(this->rect()).adjusted(4.0, 4.0, -4.0, -4.0);
+    auto point = [&](qint64 timestamp, float value) {
+        return QPointF(area.left() + area.width() * (timestamp - first) / (double)(last - first),
+            area.bottom() - area.height() * (value - min) / (max - min));
+    };
+
+    // draw one polyline per region
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (mpFlow::dtype::index region = 0; region < this->history().rows(); ++region) {
+        QPainterPath path;
+        for (mpFlow::dtype::index position = 0; position < this->history().size(); ++position) {
+            mpFlow::dtype::index slot = this->history().slot(position);
+            QPointF p = point(this->history().timestamps()(slot), this->history().values()(region, slot));
+            if (position == 0) {
+                path.moveTo(p);
+            } else {
+                path.lineTo(p);
+            }
+        }
+        painter.setPen(QPen(region_colors[region % (sizeof(region_colors) / sizeof(region_colors[0]))], 1.5));
+        painter.drawPath(path);
+    }
+
+    // legend and value range in mS
+    int line_height = painter.fontMetrics().height();
+    for (mpFlow::dtype::index region = 0; region < this->names().size(); ++region) {
+        painter.setPen(region_colors[region % (sizeof(region_colors) / sizeof(region_colors[0]))]);
+        painter.drawText(QPointF(area.left() + 4.0, area.top() + line_height * (region + 1)),
+            this->names()[region]);
+    }
+    painter.setPen(Qt::darkGray);
+    painter.drawText(area, Qt::AlignRight | Qt::AlignTop, QString("%1 mS").arg(max * 1e3));
+    painter.drawText(area, Qt::AlignRight | Qt::AlignBottom, QString("%1 mS").arg(min * 1e3));
+}
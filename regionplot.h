@@ -0,0 +1,32 @@
+#ifndef REGIONPLOT_H
+#define REGIONPLOT_H
+
+#include <QWidget>
+#include <memory>
+#include "regionsofinterest.h"
+#include "framehistory.h"
+
+// plots regional mean conductivity of the last seconds, one curve per region
+class RegionPlot : public QWidget {
+    Q_OBJECT
+public:
+    explicit RegionPlot(double duration=30.0, QWidget* parent=nullptr);
+
+public slots:
+    void add_samples(std::shared_ptr<const RegionSamples> samples);
+    void clear();
+
+protected:
+    virtual void paintEvent(QPaintEvent* event);
+
+public:
+    // accessors
+    FrameHistory& history() { return this->history_; }
+    QStringList& names() { return this->names_; }
+
+private:
+    FrameHistory history_;
+    QStringList names_;
+};
+
+#endif // REGIONPLOT_H
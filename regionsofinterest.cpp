@@ -0,0 +1,45 @@
+#include "regionsofinterest.h"
+
+RegionsOfInterest::RegionsOfInterest(const Eigen::ArrayXXf& nodes,
+    const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+    const Eigen::ArrayXf& element_area) :
+    centers_(2, elements.rows()), element_area_(element_area) {
+    // regions are assigned by element centers
+    for (mpFlow::dtype::index element = 0; element < elements.rows(); ++element) {
+        this->centers_.col(element) = (nodes.col(elements(element, 0)) +
+            nodes.col(elements(element, 1)) + nodes.col(elements(element, 2))) / 3.0;
+    }
+
+    this->add_region("global", [](float, float) { return true; });
+    this->add_region("right", [](float x, float) { return x < 0.0; });
+    this->add_region("left", [](float x, float) { return x >= 0.0; });
+    this->add_region("ventral", [](float, float y) { return y >= 0.0; });
+    this->add_region("dorsal", [](float, float y) { return y < 0.0; });
+    this->add_region("ventral right", [](float x, float y) { return (x < 0.0) && (y >= 0.0); });
+    this->add_region("ventral left", [](float x, float y) { return (x >= 0.0) && (y >= 0.0); });
+    this->add_region("dorsal right", [](float x, float y) { return (x < 0.0) && (y < 0.0); });
+    this->add_region("dorsal left", [](float x, float y) { return (x >= 0.0) && (y < 0.0); });
+}
+
+void RegionsOfInterest::add_region(const QString& name,
+    std::function<bool(float x, float y)> contains) {
+    // collect elements and area of region
+    std::vector<mpFlow::dtype::index> region_elements;
+    float area = 0.0;
+    for (mpFlow::dtype::index element = 0; element < this->centers_.cols(); ++element) {
+        if (contains(this->centers_(0, element), this->centers_(1, element))) {
+            region_elements.push_back(element);
+            area += this->element_area_(element);
+        }
+    }
+
+    // weights of empty regions stay zero
+    for (const auto element : region_elements) {
+        this->triplets_.push_back(Eigen::Triplet<float>(this->names_.size(), element,
+            this->element_area_(element) / area));
+    }
+    this->names_.append(name);
+
+    this->weights_.resize(this->names_.size(), this->centers_.cols());
+    this->weights_.setFromTriplets(this->triplets_.begin(), this->triplets_.end());
+}
@@ -0,0 +1,55 @@
+#ifndef REGIONSOFINTEREST_H
+#define REGIONSOFINTEREST_H
+
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <mpflow/mpflow.h>
+
+// regions of interest over mesh elements, each region is compiled into one
+// row of a sparse matrix holding the areas of its elements normalized to the
+// region area, so area weighted mean values of all regions and all frames of
+// a batch are a single sparse gather reduce
+class RegionsOfInterest {
+public:
+    // creates global, right, left, ventral, dorsal and quadrant regions,
+    // image is seen from caudal with ventral side up, so patient right is on
+    // the negative x side
+    RegionsOfInterest(const Eigen::ArrayXXf& nodes,
+        const Eigen::Array<mpFlow::dtype::index, Eigen::Dynamic, Eigen::Dynamic>& elements,
+        const Eigen::ArrayXf& element_area);
+
+    // adds region of all elements with center inside of it
+    void add_region(const QString& name, std::function<bool(float x, float y)> contains);
+
+    // mean value of each region (rows) for each frame (columns)
+    Eigen::ArrayXXf apply(const Eigen::Ref<const Eigen::ArrayXXf>& data) const {
+        return (this->weights() * data.matrix()).array();
+    }
+
+public:
+    // accessors
+    const QStringList& names() const { return this->names_; }
+    const Eigen::SparseMatrix<float, Eigen::RowMajor>& weights() const { return this->weights_; }
+    mpFlow::dtype::index count() const { return this->names_.size(); }
+    mpFlow::dtype::index element_count() const { return this->element_area_.size(); }
+
+private:
+    Eigen::ArrayXXf centers_;
+    Eigen::ArrayXf element_area_;
+    QStringList names_;
+    std::vector<Eigen::Triplet<float>> triplets_;
+    Eigen::SparseMatrix<float, Eigen::RowMajor> weights_;
+};
+
+// regional mean values of consecutive frames, ids count analysed frames
+struct RegionSamples {
+    quint64 first_id;
+    std::shared_ptr<const RegionsOfInterest> regions;
+    Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps;
+    Eigen::ArrayXXf values;
+};
+
+#endif // REGIONSOFINTEREST_H
@@ -0,0 +1,137 @@
+#include "renderpreparer.h"
+#include "profiler.h"
+
+RenderPreparer::RenderPreparer(QObject* parent) :
+    QObject(parent), prepare_time_(0.0), node_averaging_(nullptr), mesh_lod_(nullptr), sigma_ref_(0.0),
+    threashold_(0.02), row_alignment_(1), level_(0), mesh_generation_(0) {
+    // create separat thread
+    this->thread_ = new QThread(this);
+    this->thread()->setObjectName("render preparer");
+    this->moveToThread(this->thread());
+
+    this->thread()->start();
+}
+
+void RenderPreparer::init(const Eigen::SparseMatrix<float, Eigen::RowMajor>& node_averaging,
+    std::shared_ptr<MeshLOD> mesh_lod, mpFlow::dtype::real sigma_ref,
+    mpFlow::dtype::index row_alignment, quint64 mesh_generation) {
+    // operator is shared with batches in preparation, it is never modified in place
+    auto averaging = std::make_shared<const Eigen::SparseMatrix<float, Eigen::RowMajor>>(node_averaging);
+    QMutexLocker locker(&this->mutex_);
+
+    this->node_averaging_ = averaging;
+    this->mesh_lod_ = mesh_lod;
+    this->sigma_ref_ = sigma_ref;
+    this->row_alignment_ = row_alignment;
+    this->level_ = 0;
+    this->mesh_generation_ = mesh_generation;
+}
+
+void RenderPreparer::set_threashold(mpFlow::dtype::real threashold) {
+    QMutexLocker locker(&this->mutex_);
+
+    this->threashold_ = threashold;
+}
+
+void RenderPreparer::set_level(mpFlow::dtype::index level) {
+    QMutexLocker locker(&this->mutex_);
+
+    this->level_ = level;
+}
+
+mpFlow::dtype::index RenderPreparer::aligned_rows(mpFlow::dtype::index rows,
+    mpFlow::dtype::index row_alignment) {
+    return (rows + row_alignment - 1) / row_alignment * row_alignment;
+}
+
+void RenderPreparer::prepare(const Eigen::Ref<const Eigen::ArrayXXf>& data,
+    const Eigen::SparseMatrix<float, Eigen::RowMajor>& node_averaging,
+    mpFlow::dtype::real sigma_ref, mpFlow::dtype::real threashold,
+    Eigen::Ref<Eigen::ArrayXXf> element_values, Eigen::Ref<Eigen::ArrayXXf> z_values) {
+    // calc norm of each frame and prevent division by zero
+    Eigen::ArrayXXf deviation = data - sigma_ref;
+    Eigen::ArrayXXf norm = (-deviation.colwise().minCoeff()).max(
+        deviation.colwise().maxCoeff()).max(threashold * sigma_ref);
+    norm = (norm == 0.0).select(1.0, norm);
+
+    // subtract reference conductivity and normalize all frames to a range between 0.0 and 1.0
+    element_values.topRows(data.rows()) = 0.5 * (deviation.rowwise() / norm.row(0)) + 0.5;
+
+    // calc z values of all frames with a single sparse matrix product
+    z_values.matrix() = node_averaging * element_values.topRows(data.rows()).matrix();
+}
+
+void RenderPreparer::restrict(MeshLOD::Level& level,
+    const Eigen::Ref<const Eigen::ArrayXXf>& element_values,
+    const Eigen::Ref<const Eigen::ArrayXXf>& z_values,
+    Eigen::Ref<Eigen::ArrayXXf> lod_element_values, Eigen::Ref<Eigen::ArrayXXf> lod_z_values) {
+    // restrict full resolution values onto coarse display mesh
+    lod_element_values.topRows(level.elements.rows()).matrix() = level.element_restriction *
+        element_values.topRows(level.element_restriction.cols()).matrix();
+    lod_z_values.matrix() = level.node_restriction * z_values.matrix();
+}
+
+void RenderPreparer::update_data(Eigen::ArrayXXf data, double time_elapsed, double timestamp,
+    std::shared_ptr<FrameTrace> trace) {
+    PROFILE_ZONE("render prepare");
+    this->time().restart();
+
+    // batch is prepared with a snapshot of the parameters, so the gui thread
+    // changing threashold or level never waits for a preparation to finish
+    std::shared_ptr<const Eigen::SparseMatrix<float, Eigen::RowMajor>> node_averaging;
+    std::shared_ptr<MeshLOD> mesh_lod;
+    mpFlow::dtype::real sigma_ref, threashold;
+    mpFlow::dtype::index row_alignment, level_index;
+    quint64 mesh_generation;
+    {
+        QMutexLocker locker(&this->mutex_);
+        node_averaging = this->node_averaging_;
+        mesh_lod = this->mesh_lod_;
+        sigma_ref = this->sigma_ref_;
+        threashold = this->threashold_;
+        row_alignment = this->row_alignment_;
+        level_index = this->level_;
+        mesh_generation = this->mesh_generation_;
+    }
+
+    // data of a solver queued before the mesh changed does not fit anymore
+    if ((node_averaging == nullptr) || (data.rows() != node_averaging->cols())) {
+        return;
+    }
+
+    // prepare buffers for complete batch at once
+    auto frames = std::make_shared<RenderFrames>();
+    frames->element_values = Eigen::ArrayXXf::Zero(RenderPreparer::aligned_rows(
+        data.rows(), row_alignment), data.cols());
+    frames->z_values = Eigen::ArrayXXf::Zero(node_averaging->rows(), data.cols());
+    RenderPreparer::prepare(data, *node_averaging, sigma_ref, threashold,
+        frames->element_values, frames->z_values);
+    frames->data = data;
+    frames->mesh_generation = mesh_generation;
+
+    // create buffers of selected level of detail
+    if ((mesh_lod != nullptr) && (level_index > 0) &&
+        (level_index < mesh_lod->levels().size())) {
+        auto& level = mesh_lod->levels()[level_index];
+        frames->level = level_index;
+        frames->lod_element_values = Eigen::ArrayXXf::Zero(RenderPreparer::aligned_rows(
+            level.elements.rows(), row_alignment), data.cols());
+        frames->lod_z_values = Eigen::ArrayXXf::Zero(level.nodes.cols(), data.cols());
+        RenderPreparer::restrict(level, frames->element_values, frames->z_values,
+            frames->lod_element_values, frames->lod_z_values);
+    }
+
+    // frames of batch were acquired evenly spaced, last one at given time stamp
+    frames->timestamps = Eigen::ArrayXd::LinSpaced(data.cols(),
+        timestamp - time_elapsed * (double)(data.cols() - 1) / (double)data.cols(), timestamp);
+
+    this->prepare_time() = this->time().elapsed();
+
+    // trace is complete up to presentation, it is only read from now on
+    if (trace) {
+        trace->stamp(FrameTrace::render_prepare);
+    }
+    frames->trace = trace;
+
+    emit this->frames_ready(frames, time_elapsed);
+}
@@ -0,0 +1,79 @@
+#ifndef RENDERPREPARER_H
+#define RENDERPREPARER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <Eigen/Sparse>
+#include <mpflow/mpflow.h>
+#include "highprecisiontime.h"
+#include "meshlod.h"
+#include "latencytracer.h"
+
+// ready to draw buffers for all frames of one reconstructed batch,
+// each column holds one frame, buffers of the selected level of detail
+// are only filled for levels coarser than the full resolution mesh,
+// the mesh generation tells batches of a previous mesh apart
+struct RenderFrames {
+    Eigen::ArrayXXf data;
+    Eigen::ArrayXd timestamps;
+    Eigen::ArrayXXf element_values;
+    Eigen::ArrayXXf z_values;
+    mpFlow::dtype::index level = 0;
+    quint64 mesh_generation = 0;
+    Eigen::ArrayXXf lod_element_values;
+    Eigen::ArrayXXf lod_z_values;
+    std::shared_ptr<const FrameTrace> trace;
+};
+
+class RenderPreparer : public QObject {
+    Q_OBJECT
+public:
+    explicit RenderPreparer(QObject* parent=nullptr);
+
+    void init(const Eigen::SparseMatrix<float, Eigen::RowMajor>& node_averaging,
+        std::shared_ptr<MeshLOD> mesh_lod, mpFlow::dtype::real sigma_ref,
+        mpFlow::dtype::index row_alignment, quint64 mesh_generation);
+    void set_threashold(mpFlow::dtype::real threashold);
+    void set_level(mpFlow::dtype::index level);
+
+    static mpFlow::dtype::index aligned_rows(mpFlow::dtype::index rows,
+        mpFlow::dtype::index row_alignment);
+
+    static void prepare(const Eigen::Ref<const Eigen::ArrayXXf>& data,
+        const Eigen::SparseMatrix<float, Eigen::RowMajor>& node_averaging,
+        mpFlow::dtype::real sigma_ref, mpFlow::dtype::real threashold,
+        Eigen::Ref<Eigen::ArrayXXf> element_values, Eigen::Ref<Eigen::ArrayXXf> z_values);
+    static void restrict(MeshLOD::Level& level,
+        const Eigen::Ref<const Eigen::ArrayXXf>& element_values,
+        const Eigen::Ref<const Eigen::ArrayXXf>& z_values,
+        Eigen::Ref<Eigen::ArrayXXf> lod_element_values, Eigen::Ref<Eigen::ArrayXXf> lod_z_values);
+
+signals:
+    void frames_ready(std::shared_ptr<RenderFrames> frames, double time_elapsed);
+
+public slots:
+    void update_data(Eigen::ArrayXXf data, double time_elapsed, double timestamp,
+        std::shared_ptr<FrameTrace> trace);
+
+public:
+    // accessors
+    QThread* thread() { return this->thread_; }
+    HighPrecisionTime& time() { return this->time_; }
+    double& prepare_time() { return this->prepare_time_; }
+
+private:
+    QThread* thread_;
+    QMutex mutex_;
+    HighPrecisionTime time_;
+    double prepare_time_;
+    std::shared_ptr<const Eigen::SparseMatrix<float, Eigen::RowMajor>> node_averaging_;
+    std::shared_ptr<MeshLOD> mesh_lod_;
+    mpFlow::dtype::real sigma_ref_;
+    mpFlow::dtype::real threashold_;
+    mpFlow::dtype::index row_alignment_;
+    mpFlow::dtype::index level_;
+    quint64 mesh_generation_;
+};
+
+#endif // RENDERPREPARER_H
@@ -1,5 +1,6 @@
 #include "solver.h"
-#include <distmesh/distmesh.h>
+#include "profiler.h"
+#include "meshgenerator.h"
 
 template <
     class type
@@ -103,19 +104,8 @@ std::tuple<
     std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::index>>,
     std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::index>>>
     Solver::createMeshFromConfig(const QJsonObject& config, cudaStream_t stream) {
-    // extract parameter from config
-    distmesh::dtype::real radius = config["radius"].toDouble();
-    distmesh::dtype::array<distmesh::dtype::real> bounding_box(2, 2);
-    bounding_box << -1.1 * radius, 1.1 * radius, -1.1 * radius, 1.1 * radius;
-
-    // create mesh using libdistmesh
-    auto distance_function = distmesh::distance_function::circular(radius);
-    auto mesh = distmesh::distmesh(distance_function, config["outer_edge_length"].toDouble(),
-        1.0 + (1.0 - config["inner_edge_length"].toDouble() / config["outer_edge_length"].toDouble()) * distance_function / radius,
-        bounding_box);
-
-    // get boundary
-    auto boundary = distmesh::boundedges(std::get<1>(mesh));
+    // same mesh as cpu forward simulator
+    auto mesh = meshgenerator::createMeshFromConfig(config);
 
     // convert to mpflow matrix
     auto nodes_gpu = mpFlow::numeric::matrix::fromEigen<mpFlow::dtype::real, distmesh::dtype::real>(
@@ -123,7 +113,7 @@ std::tuple<
     auto elements_gpu = mpFlow::numeric::matrix::fromEigen<mpFlow::dtype::index, distmesh::dtype::index>(
         std::get<1>(mesh), stream);
     auto boundary_gpu = mpFlow::numeric::matrix::fromEigen<mpFlow::dtype::index, distmesh::dtype::index>(
-        boundary, stream);
+        std::get<2>(mesh), stream);
 
     return std::make_tuple(nodes_gpu, elements_gpu, boundary_gpu);
 }
@@ -137,6 +127,7 @@ Solver::Solver(const QJsonObject& config,
     cuda_device_(cuda_device) {
     // init separate thread
     this->thread_ = new QThread(this);
+    this->thread()->setObjectName("solver");
     this->moveToThread(this->thread());
 
     // create solver once thread is started
@@ -165,7 +156,14 @@ Solver::Solver(const QJsonObject& config,
     this->thread()->start();
 }
 
-void Solver::solve(std::vector<std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::real>>>* data) {
+void Solver::solve(std::vector<std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::real>>>* data,
+    double time_elapsed, double timestamp, std::shared_ptr<FrameTrace> trace) {
+    Q_UNUSED(time_elapsed);
+    PROFILE_ZONE("solve");
+    if (trace) {
+        trace->stamp(FrameTrace::solve_start);
+    }
+
     // copy data to solver
     for (mpFlow::dtype::index i = 0; i < data->size(); ++i) {
         this->eit_solver()->measurement()[i]->copy((*data)[i], this->cuda_stream());
@@ -179,11 +177,18 @@ void Solver::solve(std::vector<std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::d
 
     cudaStreamSynchronize(this->cuda_stream());
     this->solve_time() = this->time().elapsed();
+    if (trace) {
+        trace->stamp(FrameTrace::solve_end);
+    }
 
     // convert eit solver data to Siemens
     Eigen::ArrayXXf result = this->eit_solver()->forward_solver()->model()->sigma_ref() *
         (mpFlow::numeric::matrix::toEigen<mpFlow::dtype::real>(solver_result) * std::log(10.0) / 10.0).exp();
 
-    emit this->data_ready(result, this->repeat_time().elapsed());
+    if (trace) {
+        trace->stamp(FrameTrace::host_conversion);
+    }
+
+    emit this->data_ready(result, this->repeat_time().elapsed(), timestamp, trace);
     this->repeat_time().restart();
 }
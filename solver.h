@@ -7,6 +7,7 @@
 #include <QJsonArray>
 #include <mpflow/mpflow.h>
 #include "highprecisiontime.h"
+#include "latencytracer.h"
 
 class Solver : public QObject {
     Q_OBJECT
@@ -34,10 +35,12 @@ public:
 
 signals:
     void initialized(bool success);
-    void data_ready(Eigen::ArrayXXf data, double time_elapsed);
+    void data_ready(Eigen::ArrayXXf data, double time_elapsed, double timestamp,
+        std::shared_ptr<FrameTrace> trace);
 
 public slots:
-    void solve(std::vector<std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::real>>>* data);
+    void solve(std::vector<std::shared_ptr<mpFlow::numeric::Matrix<mpFlow::dtype::real>>>* data,
+        double time_elapsed, double timestamp, std::shared_ptr<FrameTrace> trace);
 
 public:
     // accessors
@@ -0,0 +1,248 @@
+#include <QtConcurrent>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "textexporter.h"
+#include "highprecisiontime.h"
+
+// size of text formatted by one thread at once
+static const qint64 chunk_bytes = 4 * 1024 * 1024;
+
+// powers of ten covering all scalings of float values to 9 digit mantissas
+static const int pow10_offset = 64;
+static double pow10_table[2 * pow10_offset + 1];
+static const bool pow10_initialized = []() {
+    for (int i = -pow10_offset; i <= pow10_offset; ++i) {
+        pow10_table[i + pow10_offset] = std::pow(10.0, i);
+    }
+    return true;
+}();
+
+TextExporter::TextExporter(char separator, int precision) :
+    separator_(separator), precision_(std::min(std::max(precision, 1), 9)), bytes_written_(0) {
+}
+
+double TextExporter::export_frames(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+    const Eigen::Ref<const Eigen::ArrayXXf>& frames, QIODevice* device) {
+    if ((device == nullptr) || !device->isWritable()) {
+        throw std::invalid_argument("TextExporter::export_frames: device not writable");
+    }
+
+    HighPrecisionTime time;
+    this->bytes_written() = 0;
+
+    this->write_header(frames.rows(), device);
+    this->write_frames(timestamps, frames, device);
+
+    return (double)this->bytes_written() / time.elapsed() * 1e-6;
+}
+
+double TextExporter::export_log(LogReader* reader, QIODevice* device) {
+    if ((device == nullptr) || !device->isWritable()) {
+        throw std::invalid_argument("TextExporter::export_log: device not writable");
+    }
+    if ((reader == nullptr) || !reader->is_open()) {
+        throw std::invalid_argument("TextExporter::export_log: log not open");
+    }
+
+    HighPrecisionTime time;
+    this->bytes_written() = 0;
+
+    // read one chunk per thread at once, so memory use is bounded
+    this->write_header(reader->rows(), device);
+    mpFlow::dtype::index count = this->frames_per_chunk(reader->rows()) *
+        std::max(1, QThread::idealThreadCount());
+    for (mpFlow::dtype::index first = 0; first < reader->frame_count(); first += count) {
+        Eigen::ArrayXXf frames = reader->frames(first, count);
+        Eigen::Array<qint64, Eigen::Dynamic, 1> timestamps(frames.cols());
+        for (mpFlow::dtype::index frame = 0; frame < frames.cols(); ++frame) {
+            timestamps(frame) = reader->timestamp(first + frame);
+        }
+        this->write_frames(timestamps, frames, device);
+    }
+
+    return (double)this->bytes_written() / time.elapsed() * 1e-6;
+}
+
+int TextExporter::format_float(float value, int precision, char* buffer) {
+    char* output = buffer;
+
+    // special values
+    if (std::signbit(value)) {
+        *output++ = '-';
+        value = -value;
+    }
+    if (std::isnan(value)) {
+        std::memcpy(output, "nan", 3);
+        return output - buffer + 3;
+    }
+    if (std::isinf(value)) {
+        std::memcpy(output, "inf", 3);
+        return output - buffer + 3;
+    }
+    if (value == 0.0f) {
+        *output++ = '0';
+        return output - buffer;
+    }
+
+    // scale to integer mantissa with precision digits, ties are rounded to even
+    // like printf does, estimated exponent is corrected afterwards
+    static const uint64_t limits[] = { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull,
+        1000000ull, 10000000ull, 100000000ull, 1000000000ull };
+    precision = std::min(std::max(precision, 1), 9);
+    int exponent = (int)std::floor(std::log10((double)value));
+    uint64_t mantissa = (uint64_t)std::nearbyint((double)value *
+        pow10_table[precision - 1 - exponent + pow10_offset]);
+    if (mantissa < limits[precision - 1]) {
+        exponent -= 1;
+        mantissa = (uint64_t)std::nearbyint((double)value *
+            pow10_table[precision - 1 - exponent + pow10_offset]);
+    }
+    if (mantissa >= limits[precision]) {
+        exponent += 1;
+        mantissa = (uint64_t)std::nearbyint((double)value *
+            pow10_table[precision - 1 - exponent + pow10_offset]);
+    }
+
+    // mantissa digits without trailing zeros
+    char digits[9];
+    for (int i = precision - 1; i >= 0; --i) {
+        digits[i] = '0' + mantissa % 10;
+        mantissa /= 10;
+    }
+    int digit_count = precision;
+    while ((digit_count > 1) && (digits[digit_count - 1] == '0')) {
+        --digit_count;
+    }
+
+    // fixed or scientific notation, as chosen by %g
+    if ((exponent < -4) || (exponent >= precision)) {
+        *output++ = digits[0];
+        if (digit_count > 1) {
+            *output++ = '.';
+            std::memcpy(output, digits + 1, digit_count - 1);
+            output += digit_count - 1;
+        }
+        *output++ = 'e';
+        *output++ = exponent < 0 ? '-' : '+';
+        int magnitude = std::abs(exponent);
+        if (magnitude >= 100) {
+            *output++ = '0' + magnitude / 100;
+        }
+        *output++ = '0' + (magnitude / 10) % 10;
+        *output++ = '0' + magnitude % 10;
+    } else if (exponent >= 0) {
+        for (int i = 0; i <= exponent; ++i) {
+            *output++ = i < digit_count ? digits[i] : '0';
+        }
+        if (digit_count > exponent + 1) {
+            *output++ = '.';
+            std::memcpy(output, digits + exponent + 1, digit_count - exponent - 1);
+            output += digit_count - exponent - 1;
+        }
+    } else {
+        *output++ = '0';
+        *output++ = '.';
+        for (int i = 0; i < -exponent - 1; ++i) {
+            *output++ = '0';
+        }
+        std::memcpy(output, digits, digit_count);
+        output += digit_count;
+    }
+
+    return output - buffer;
+}
+
+int TextExporter::format_integer(qint64 value, char* buffer) {
+    char* output = buffer;
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    if (value < 0) {
+        *output++ = '-';
+    }
+
+    // digits in reverse order first
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    while (count > 0) {
+        *output++ = digits[--count];
+    }
+
+    return output - buffer;
+}
+
+void TextExporter::write_header(mpFlow::dtype::index rows, QIODevice* device) {
+    QByteArray header("timestamp");
+    for (mpFlow::dtype::index row = 0; row < rows; ++row) {
+        header += this->separator();
+        header += QByteArray::number((qlonglong)row);
+    }
+    header += '\n';
+    this->write(header, device);
+}
+
+void TextExporter::write_frames(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+    const Eigen::Ref<const Eigen::ArrayXXf>& frames, QIODevice* device) {
+    // format chunks in parallel and write them in order
+    std::vector<std::pair<mpFlow::dtype::index, mpFlow::dtype::index>> chunks;
+    mpFlow::dtype::index chunk_size = this->frames_per_chunk(frames.rows());
+    for (mpFlow::dtype::index first = 0; first < frames.cols(); first += chunk_size) {
+        chunks.push_back(std::make_pair(first, std::min(chunk_size,
+            (mpFlow::dtype::index)frames.cols() - first)));
+    }
+
+    mpFlow::dtype::index threads = std::max(1, QThread::idealThreadCount());
+    for (mpFlow::dtype::index wave = 0; wave < chunks.size(); wave += threads) {
+        std::vector<std::pair<mpFlow::dtype::index, mpFlow::dtype::index>> wave_chunks(
+            chunks.begin() + wave, chunks.begin() + std::min(wave + threads,
+                (mpFlow::dtype::index)chunks.size()));
+        std::function<QByteArray(const std::pair<mpFlow::dtype::index, mpFlow::dtype::index>&)> format_chunk =
+            [&](const std::pair<mpFlow::dtype::index, mpFlow::dtype::index>& chunk) {
+            return this->format(timestamps.segment(chunk.first, chunk.second),
+                frames.middleCols(chunk.first, chunk.second));
+        };
+        QList<QByteArray> texts = QtConcurrent::blockingMapped<QList<QByteArray>>(
+            wave_chunks, format_chunk);
+
+        for (const auto& text : texts) {
+            this->write(text, device);
+        }
+    }
+}
+
+void TextExporter::write(const QByteArray& text, QIODevice* device) {
+    if (device->write(text) != text.size()) {
+        throw std::runtime_error("TextExporter::write: cannot write text");
+    }
+    this->bytes_written() += text.size();
+}
+
+QByteArray TextExporter::format(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+    const Eigen::Ref<const Eigen::ArrayXXf>& frames) {
+    // allocate for worst case and shrink afterwards
+    QByteArray text;
+    text.resize(frames.cols() * (21 + frames.rows() * 17));
+    char* output = text.data();
+
+    for (mpFlow::dtype::index frame = 0; frame < frames.cols(); ++frame) {
+        output += TextExporter::format_integer(timestamps(frame), output);
+        for (mpFlow::dtype::index row = 0; row < frames.rows(); ++row) {
+            *output++ = this->separator();
+            output += TextExporter::format_float(frames(row, frame), this->precision(), output);
+        }
+        *output++ = '\n';
+    }
+    text.resize(output - text.data());
+
+    return text;
+}
+
+mpFlow::dtype::index TextExporter::frames_per_chunk(mpFlow::dtype::index rows) {
+    // estimated line length of typical values
+    return std::max((qint64)1, chunk_bytes / (qint64)(21 + rows * (this->precision() + 6)));
+}
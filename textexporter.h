@@ -0,0 +1,46 @@
+#ifndef TEXTEXPORTER_H
+#define TEXTEXPORTER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <Eigen/Dense>
+#include <mpflow/mpflow.h>
+#include "logreader.h"
+
+// writes frame logs as csv or tsv text, one line per frame starting with its
+// time stamp, chunks of frames are formatted in parallel on all cores with a
+// printf %g compatible float formatter and written with few large writes
+class TextExporter {
+public:
+    explicit TextExporter(char separator=',', int precision=7);
+
+    double export_frames(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+        const Eigen::Ref<const Eigen::ArrayXXf>& frames, QIODevice* device);
+    double export_log(LogReader* reader, QIODevice* device);
+
+    // format into buffer and return number of written chars, float needs up to 16 chars
+    static int format_float(float value, int precision, char* buffer);
+    static int format_integer(qint64 value, char* buffer);
+
+protected:
+    void write_header(mpFlow::dtype::index rows, QIODevice* device);
+    void write_frames(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+        const Eigen::Ref<const Eigen::ArrayXXf>& frames, QIODevice* device);
+    void write(const QByteArray& text, QIODevice* device);
+    QByteArray format(const Eigen::Ref<const Eigen::Array<qint64, Eigen::Dynamic, 1>>& timestamps,
+        const Eigen::Ref<const Eigen::ArrayXXf>& frames);
+    mpFlow::dtype::index frames_per_chunk(mpFlow::dtype::index rows);
+
+public:
+    // accessors
+    char& separator() { return this->separator_; }
+    int& precision() { return this->precision_; }
+    qint64& bytes_written() { return this->bytes_written_; }
+
+private:
+    char separator_;
+    int precision_;
+    qint64 bytes_written_;
+};
+
+#endif // TEXTEXPORTER_H